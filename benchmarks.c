@@ -0,0 +1,555 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "src/tp1.h"
+#include "src/hospital.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CANTIDAD_POR_DEFECTO 2000000
+#define REPETICIONES 3
+#define ARCHIVO_BENCHMARK "benchmark_hospital.txt"
+#define CONSULTAS_PEORES 100000
+#define K_PEORES 20
+#define LOTES_COLA 16384
+#define POKEMON_POR_LOTE_COLA 32
+#define ARCHIVO_BASE_COLA "ejemplos/grande.txt"
+#define MAXIMO_PRODUCTORES 64
+#define RECORRIDOS_LECTORES 32
+#define RECORRIDOS_PARALELOS 8
+
+/**
+ * Escribe un archivo con la cantidad de pokemon indicada y saludes entre 0 y
+ * 100, como los de ejemplos/.
+ *
+ * Devuelve false en caso de error.
+*/
+bool escribir_archivo(const char *ruta, size_t cantidad)
+{
+	FILE *archivo = fopen(ruta, "w");
+	if (!archivo)
+		return false;
+	for (size_t i = 0; i < cantidad; i++)
+		fprintf(archivo, "%zu,Pokemon%zu,%zu,Entrenador%zu\n", i, i % 997,
+			(i * 2654435761u) % 101, i % 211);
+	return fclose(archivo) == 0;
+}
+
+/**
+ * Devuelve los segundos transcurridos desde una referencia fija.
+*/
+double segundos_actuales(void)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (double)ahora.tv_sec + (double)ahora.tv_nsec / 1e9;
+}
+
+/**
+ * Carga el archivo varias veces con la cantidad de hilos indicada y devuelve
+ * el menor de los tiempos, o un numero negativo si la carga falla.
+*/
+double medir_carga(const char *ruta, size_t hilos)
+{
+	hospital_establecer_hilos(hilos);
+	double mejor = -1;
+	for (size_t i = 0; i < REPETICIONES; i++) {
+		double inicio = segundos_actuales();
+		hospital_t *hospital = hospital_crear_desde_archivo(ruta);
+		double tiempo = segundos_actuales() - inicio;
+		if (!hospital)
+			return -1;
+		hospital_destruir(hospital);
+		if (mejor < 0 || tiempo < mejor)
+			mejor = tiempo;
+	}
+	return mejor;
+}
+
+/**
+ * Devuelve la siguiente cantidad de hilos a medir: se duplica en cada paso,
+ * pero el maximo se mide siempre aunque no sea potencia de 2.
+*/
+size_t siguiente_cantidad_hilos(size_t hilos, size_t maximo)
+{
+	if (hilos < maximo && hilos * 2 > maximo)
+		return maximo;
+	return hilos * 2;
+}
+
+/**
+ * Vector donde se guardan los primeros k pokemon recorridos con
+ * hospital_a_cada_pokemon().
+*/
+typedef struct primeros {
+	pokemon_t **vector;
+	size_t cantidad;
+	size_t k;
+} primeros_t;
+
+/**
+ * Guarda el pokemon recorrido y corta el recorrido al llegar a k.
+*/
+bool guardar_primero(pokemon_t *pokemon, void *primeros)
+{
+	primeros_t *datos = primeros;
+	datos->vector[datos->cantidad++] = pokemon;
+	return datos->cantidad < datos->k;
+}
+
+/**
+ * Compara, sobre un hospital cargado del archivo, el tiempo por consulta de
+ * obtener los K_PEORES pokemon de mayor prioridad con hospital_peores_k() y
+ * con hospital_a_cada_pokemon() cortando el recorrido en el k-esimo.
+ *
+ * Devuelve false en caso de error.
+*/
+bool medir_peores_k(const char *ruta)
+{
+	hospital_t *hospital = hospital_crear_desde_archivo(ruta);
+	if (!hospital)
+		return false;
+	pokemon_t *peores[K_PEORES];
+	printf("\nLos %d pokemon de mayor prioridad (%d consultas)\n", K_PEORES,
+	       CONSULTAS_PEORES);
+	printf("%-32s %14s\n", "metodo", "us/consulta");
+
+	double inicio = segundos_actuales();
+	size_t obtenidos = 0;
+	for (size_t i = 0; i < CONSULTAS_PEORES; i++)
+		obtenidos += hospital_peores_k(hospital, K_PEORES, peores);
+	double tiempo = segundos_actuales() - inicio;
+	printf("%-32s %14.3f\n", "hospital_peores_k",
+	       tiempo * 1e6 / CONSULTAS_PEORES);
+
+	inicio = segundos_actuales();
+	for (size_t i = 0; i < CONSULTAS_PEORES; i++) {
+		primeros_t primeros = { .vector = peores, .k = K_PEORES };
+		obtenidos -= hospital_a_cada_pokemon(hospital, guardar_primero,
+						     &primeros);
+	}
+	tiempo = segundos_actuales() - inicio;
+	printf("%-32s %14.3f\n", "hospital_a_cada_pokemon (corte)",
+	       tiempo * 1e6 / CONSULTAS_PEORES);
+	hospital_destruir(hospital);
+	return obtenidos == 0;
+}
+
+/**
+ * Hilo productor de la medicion de la cola de emergencias: encola sus lotes
+ * de POKEMON_POR_LOTE_COLA pokemon, ya creados.
+*/
+typedef struct productor {
+	cola_emergencias_t *cola;
+	pokemon_t **pokemones;
+	size_t lotes;
+} productor_t;
+
+void *producir_lotes(void *productor)
+{
+	productor_t *datos = productor;
+	for (size_t i = 0; i < datos->lotes; i++)
+		cola_emergencias_encolar(
+			datos->cola,
+			datos->pokemones + i * POKEMON_POR_LOTE_COLA,
+			POKEMON_POR_LOTE_COLA);
+	return NULL;
+}
+
+/**
+ * Crea los pokemon que encolan los productores.
+ *
+ * Devuelve el vector de pokemon o NULL en caso de error.
+*/
+pokemon_t **crear_pokemon_cola(size_t cantidad)
+{
+	pokemon_t **pokemones = malloc(cantidad * sizeof(pokemon_t *));
+	if (!pokemones)
+		return NULL;
+	char linea[64];
+	for (size_t i = 0; i < cantidad; i++) {
+		snprintf(linea, sizeof(linea), "%zu,Pokemon%zu,%zu,Ambulancia",
+			 i, i % 997, (i * 2654435761u) % 101);
+		pokemones[i] = pokemon_crear_desde_string(linea);
+		if (!pokemones[i]) {
+			for (size_t j = 0; j < i; j++)
+				pokemon_destruir(pokemones[j]);
+			free(pokemones);
+			return NULL;
+		}
+	}
+	return pokemones;
+}
+
+/**
+ * Mide cuanto tarda en ingresar al hospital LOTES_COLA lotes encolados por la
+ * cantidad de productores indicada, mientras el hilo actual drena la cola, y
+ * guarda las metricas finales de la cola.
+ *
+ * Devuelve el tiempo o un numero negativo en caso de error.
+*/
+double medir_cola(size_t cantidad_productores, metricas_cola_t *metricas)
+{
+	size_t total = LOTES_COLA * POKEMON_POR_LOTE_COLA;
+	pokemon_t **pokemones = crear_pokemon_cola(total);
+	hospital_t *hospital = hospital_crear_desde_archivo(ARCHIVO_BASE_COLA);
+	cola_emergencias_t *cola = cola_emergencias_crear();
+	if (!pokemones || !hospital || !cola) {
+		for (size_t i = 0; pokemones && i < total; i++)
+			pokemon_destruir(pokemones[i]);
+		free(pokemones);
+		hospital_destruir(hospital);
+		cola_emergencias_destruir(cola);
+		return -1;
+	}
+
+	pthread_t hilos[MAXIMO_PRODUCTORES];
+	bool lanzados[MAXIMO_PRODUCTORES];
+	productor_t productores[MAXIMO_PRODUCTORES];
+	size_t lotes_por_productor = LOTES_COLA / cantidad_productores;
+	double inicio = segundos_actuales();
+	for (size_t i = 0; i < cantidad_productores; i++) {
+		productores[i] = (productor_t){
+			.cola = cola,
+			.pokemones = pokemones +
+				     i * lotes_por_productor *
+					     POKEMON_POR_LOTE_COLA,
+			.lotes = (i + 1 == cantidad_productores) ?
+					 LOTES_COLA - i * lotes_por_productor :
+					 lotes_por_productor,
+		};
+		lanzados[i] = pthread_create(&hilos[i], NULL, producir_lotes,
+					     &productores[i]) == 0;
+		if (!lanzados[i])
+			producir_lotes(&productores[i]);
+	}
+	bool exito = true;
+	do {
+		exito = cola_emergencias_drenar(cola, hospital) == EXITO;
+		cola_emergencias_metricas(cola, metricas);
+	} while (exito && metricas->pokemon_ingresados < total);
+	double tiempo = segundos_actuales() - inicio;
+	for (size_t i = 0; i < cantidad_productores; i++)
+		if (lanzados[i])
+			pthread_join(hilos[i], NULL);
+
+	cola_emergencias_destruir(cola);
+	hospital_destruir(hospital);
+	free(pokemones);
+	return (exito) ? tiempo : -1;
+}
+
+/**
+ * Mide como escala el ingreso de emergencias a traves de la cola al
+ * aumentar la cantidad de productores, de 1 al maximo de hilos.
+ *
+ * Devuelve false en caso de error.
+*/
+bool medir_cola_emergencias(size_t maximo_hilos)
+{
+	if (maximo_hilos > MAXIMO_PRODUCTORES)
+		maximo_hilos = MAXIMO_PRODUCTORES;
+	printf("\nIngreso de %d lotes de %d pokemon por la cola de emergencias\n",
+	       LOTES_COLA, POKEMON_POR_LOTE_COLA);
+	printf("%11s %10s %14s %14s %14s\n", "productores", "segundos",
+	       "pokemon/s", "latencia (us)", "maxima (us)");
+	for (size_t productores = 1; productores <= maximo_hilos;
+	     productores = siguiente_cantidad_hilos(productores, maximo_hilos)) {
+		metricas_cola_t metricas;
+		double tiempo = medir_cola(productores, &metricas);
+		if (tiempo < 0)
+			return false;
+		printf("%11zu %10.3f %14.0f %14zu %14zu\n", productores, tiempo,
+		       (double)metricas.pokemon_ingresados / tiempo,
+		       metricas.latencia_promedio_us,
+		       metricas.latencia_maxima_us);
+	}
+	return true;
+}
+
+/**
+ * Hilo lector de la medicion de lectores concurrentes: recorre completo el
+ * hospital la cantidad de veces indicada.
+*/
+typedef struct lector {
+	hospital_t *hospital;
+	size_t recorridos;
+	size_t visitados;
+} lector_t;
+
+bool contar_visitado(pokemon_t *pokemon, void *visitados)
+{
+	(*(size_t *)visitados) += (pokemon != NULL);
+	return true;
+}
+
+void *recorrer_lector(void *lector)
+{
+	lector_t *datos = lector;
+	for (size_t i = 0; i < datos->recorridos; i++)
+		hospital_a_cada_pokemon(datos->hospital, contar_visitado,
+					&datos->visitados);
+	return NULL;
+}
+
+/**
+ * Mide cuanto tardan la cantidad de lectores indicada en hacer, entre todos,
+ * RECORRIDOS_LECTORES recorridos completos del hospital concurrente.
+ *
+ * Devuelve el tiempo o un numero negativo en caso de error.
+*/
+double medir_recorridos(hospital_t *hospital, size_t cantidad_lectores)
+{
+	pthread_t hilos[MAXIMO_PRODUCTORES];
+	bool lanzados[MAXIMO_PRODUCTORES];
+	lector_t lectores[MAXIMO_PRODUCTORES];
+	size_t por_lector = RECORRIDOS_LECTORES / cantidad_lectores;
+	double inicio = segundos_actuales();
+	for (size_t i = 0; i < cantidad_lectores; i++) {
+		lectores[i] = (lector_t){
+			.hospital = hospital,
+			.recorridos = (i + 1 == cantidad_lectores) ?
+					      RECORRIDOS_LECTORES -
+						      i * por_lector :
+					      por_lector,
+		};
+		lanzados[i] = pthread_create(&hilos[i], NULL, recorrer_lector,
+					     &lectores[i]) == 0;
+		if (!lanzados[i])
+			recorrer_lector(&lectores[i]);
+	}
+	size_t visitados = 0;
+	for (size_t i = 0; i < cantidad_lectores; i++) {
+		if (lanzados[i])
+			pthread_join(hilos[i], NULL);
+		visitados += lectores[i].visitados;
+	}
+	double tiempo = segundos_actuales() - inicio;
+	if (visitados !=
+	    RECORRIDOS_LECTORES * hospital_cantidad_pokemones(hospital))
+		return -1;
+	return tiempo;
+}
+
+/**
+ * Mide como escalan los recorridos de un hospital concurrente al aumentar la
+ * cantidad de lectores, que comparten el cerrojo del hospital.
+ *
+ * Devuelve false en caso de error.
+*/
+bool medir_lectores_concurrentes(const char *archivo, size_t maximo_hilos)
+{
+	if (maximo_hilos > MAXIMO_PRODUCTORES)
+		maximo_hilos = MAXIMO_PRODUCTORES;
+	hospital_t *hospital = hospital_crear_desde_archivo(archivo);
+	if (!hospital || hospital_habilitar_concurrencia(hospital) == ERROR) {
+		hospital_destruir(hospital);
+		return false;
+	}
+	printf("\n%d recorridos completos de un hospital concurrente\n",
+	       RECORRIDOS_LECTORES);
+	printf("%9s %10s %11s\n", "lectores", "segundos", "aceleracion");
+	double base = -1;
+	for (size_t lectores = 1; lectores <= maximo_hilos;
+	     lectores = siguiente_cantidad_hilos(lectores, maximo_hilos)) {
+		double tiempo = medir_recorridos(hospital, lectores);
+		if (tiempo < 0) {
+			hospital_destruir(hospital);
+			return false;
+		}
+		if (base < 0)
+			base = tiempo;
+		printf("%9zu %10.3f %10.2fx\n", lectores, tiempo,
+		       base / tiempo);
+	}
+	hospital_destruir(hospital);
+	return true;
+}
+
+/**
+ * Funcion del recorrido paralelo: calcula un puntaje por pokemon (algo de
+ * trabajo por cada uno, como un analisis real) y lo acumula en el aux.
+*/
+bool puntuar_pokemon(pokemon_t *pokemon, void *puntaje)
+{
+	size_t valor = pokemon_salud(pokemon) + pokemon_id(pokemon);
+	for (size_t i = 0; i < 16; i++)
+		valor = valor * 6364136223846793005u + 1442695040888963407u;
+	*(size_t *)puntaje += valor >> 32;
+	return true;
+}
+
+void sumar_puntajes(void *puntaje, void *puntaje_hilo)
+{
+	*(size_t *)puntaje += *(size_t *)puntaje_hilo;
+}
+
+/**
+ * Mide como escala hospital_a_cada_pokemon_paralelo() al aumentar la
+ * cantidad de hilos, comparando cada resultado con el del primero.
+ *
+ * Devuelve false en caso de error.
+*/
+bool medir_recorrido_paralelo(const char *archivo, size_t maximo_hilos)
+{
+	if (maximo_hilos > MAXIMO_PRODUCTORES)
+		maximo_hilos = MAXIMO_PRODUCTORES;
+	hospital_t *hospital = hospital_crear_desde_archivo(archivo);
+	if (!hospital)
+		return false;
+	printf("\n%d recorridos paralelos con un puntaje por pokemon\n",
+	       RECORRIDOS_PARALELOS);
+	printf("%6s %10s %11s\n", "hilos", "segundos", "aceleracion");
+	size_t puntajes[MAXIMO_PRODUCTORES];
+	void *aux[MAXIMO_PRODUCTORES];
+	double base = -1;
+	size_t esperado = 0;
+	bool exito = true;
+	for (size_t hilos = 1; exito && hilos <= maximo_hilos;
+	     hilos = siguiente_cantidad_hilos(hilos, maximo_hilos)) {
+		double inicio = segundos_actuales();
+		for (size_t r = 0; exito && r < RECORRIDOS_PARALELOS; r++) {
+			for (size_t i = 0; i < hilos; i++) {
+				puntajes[i] = 0;
+				aux[i] = &puntajes[i];
+			}
+			hospital_a_cada_pokemon_paralelo(hospital,
+							 puntuar_pokemon, aux,
+							 hilos, sumar_puntajes);
+			if (base < 0 && r == 0)
+				esperado = puntajes[0];
+			exito = puntajes[0] == esperado;
+		}
+		double tiempo = segundos_actuales() - inicio;
+		if (base < 0)
+			base = tiempo;
+		if (exito)
+			printf("%6zu %10.3f %10.2fx\n", hilos, tiempo,
+			       base / tiempo);
+	}
+	hospital_destruir(hospital);
+	return exito;
+}
+
+/**
+ * Pasa los pokemon del origen al destino atendiendolos de a uno e
+ * ingresandolos como emergencias, que es como se fusionaban dos hospitales
+ * antes de hospital_fusionar(), y destruye el origen.
+ *
+ * Devuelve false en caso de error.
+*/
+bool fusionar_con_emergencias(hospital_t *destino, hospital_t *origen)
+{
+	size_t cantidad = hospital_cantidad_pokemones(origen);
+	pokemon_t **pokemones = malloc((cantidad + 1) * sizeof(pokemon_t *));
+	if (!pokemones)
+		return false;
+	size_t atendidos = 0;
+	while (atendidos < cantidad &&
+	       (pokemones[atendidos] = hospital_atender_siguiente(origen)))
+		atendidos++;
+	hospital_destruir(origen);
+	bool exito = hospital_aceptar_emergencias(destino, pokemones,
+						  atendidos) == EXITO &&
+		     atendidos == cantidad;
+	free(pokemones);
+	return exito;
+}
+
+/**
+ * Compara el tiempo de fusionar dos hospitales cargados del archivo con
+ * hospital_fusionar() y pasando los pokemon como emergencias.
+*/
+bool medir_fusion(const char *archivo)
+{
+	printf("\nFusion de dos hospitales cargados del archivo\n");
+	printf("%-24s %10s\n", "metodo", "segundos");
+	for (int metodo = 0; metodo < 2; metodo++) {
+		hospital_t *destino = hospital_crear_desde_archivo(archivo);
+		hospital_t *origen = hospital_crear_desde_archivo(archivo);
+		if (!destino || !origen) {
+			hospital_destruir(destino);
+			hospital_destruir(origen);
+			return false;
+		}
+		size_t esperado = 2 * hospital_cantidad_pokemones(destino);
+		double inicio = segundos_actuales();
+		bool exito = (metodo == 0) ?
+				     hospital_fusionar(destino, origen) == EXITO :
+				     fusionar_con_emergencias(destino, origen);
+		double tiempo = segundos_actuales() - inicio;
+		exito = exito && hospital_cantidad_pokemones(destino) == esperado;
+		hospital_destruir(destino);
+		if (!exito)
+			return false;
+		printf("%-24s %10.3f\n",
+		       (metodo == 0) ? "hospital_fusionar" : "emergencias", tiempo);
+	}
+	return true;
+}
+
+/**
+ * Mide como escala la carga (lectura en tramos paralelos y ordenamiento en
+ * paralelo) de un hospital grande al aumentar la cantidad de hilos, de 1 a
+ * la cantidad de procesadores disponibles, el costo de consultar los pokemon
+ * de mayor prioridad, como escala el ingreso por la cola de emergencias con
+ * varios productores, como escalan los recorridos con varios lectores,
+ * como escala el recorrido paralelo y cuanto cuesta fusionar dos hospitales.
+ *
+ * Uso: ./benchmark [cantidad de pokemon] [maximo de hilos]
+*/
+int main(int argc, char *argv[])
+{
+	size_t cantidad = (argc > 1) ? strtoul(argv[1], NULL, 10) :
+				       CANTIDAD_POR_DEFECTO;
+	long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t maximo_hilos = (argc > 2) ? strtoul(argv[2], NULL, 10) :
+			      (procesadores > 0) ? (size_t)procesadores :
+						   1;
+	if (!escribir_archivo(ARCHIVO_BENCHMARK, cantidad)) {
+		fprintf(stderr, "No se pudo escribir %s\n", ARCHIVO_BENCHMARK);
+		return 1;
+	}
+
+	printf("Carga de %zu pokemon (%d repeticiones, mejor tiempo)\n",
+	       cantidad, REPETICIONES);
+	printf("%6s %12s %10s\n", "hilos", "segundos", "aceleracion");
+	double base = -1;
+	for (size_t hilos = 1; hilos <= maximo_hilos;
+	     hilos = siguiente_cantidad_hilos(hilos, maximo_hilos)) {
+		double tiempo = medir_carga(ARCHIVO_BENCHMARK, hilos);
+		if (tiempo < 0) {
+			fprintf(stderr, "Fallo la carga con %zu hilos\n", hilos);
+			remove(ARCHIVO_BENCHMARK);
+			return 1;
+		}
+		if (base < 0)
+			base = tiempo;
+		printf("%6zu %12.3f %10.2fx\n", hilos, tiempo, base / tiempo);
+	}
+	bool exito = medir_peores_k(ARCHIVO_BENCHMARK);
+	if (!exito)
+		fprintf(stderr, "Fallo la consulta de los peores pokemon\n");
+	if (exito && !medir_cola_emergencias(maximo_hilos)) {
+		fprintf(stderr, "Fallo el ingreso por la cola de emergencias\n");
+		exito = false;
+	}
+	if (exito && !medir_lectores_concurrentes(ARCHIVO_BENCHMARK,
+						  maximo_hilos)) {
+		fprintf(stderr, "Fallo el recorrido con lectores concurrentes\n");
+		exito = false;
+	}
+	if (exito && !medir_recorrido_paralelo(ARCHIVO_BENCHMARK, maximo_hilos)) {
+		fprintf(stderr, "Fallo el recorrido paralelo\n");
+		exito = false;
+	}
+	if (exito && !medir_fusion(ARCHIVO_BENCHMARK)) {
+		fprintf(stderr, "Fallo la fusion de hospitales\n");
+		exito = false;
+	}
+	remove(ARCHIVO_BENCHMARK);
+	return (exito) ? 0 : 1;
+}
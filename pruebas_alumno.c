@@ -1,7 +1,16 @@
 #include "pa2m.h"
 #include "src/menu.h"
 #include "src/lista.h"
+#include "src/heap.h"
+#include "src/abb.h"
+#include "src/arena.h"
+#include "src/lector.h"
+#include "src/tp1.h"
+#include "src/hospital.h"
 
+#include <glob.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -404,6 +413,1707 @@ void pruebas_ayuda_varias_opciones()
 	menu_destruir_con_lista_ayuda(menu, ayuda);
 }
 
+int comparar_enteros(void *elemento1, void *elemento2)
+{
+	return *(int *)elemento1 - *(int *)elemento2;
+}
+
+void pruebas_heap_casos_borde()
+{
+	pa2m_afirmar(heap_crear(NULL, 5) == NULL,
+		     "No se puede crear un heap sin comparador.");
+	heap_t *heap = heap_crear(comparar_enteros, 0);
+	pa2m_afirmar(heap != NULL, "Se puede crear un heap vacio.");
+	pa2m_afirmar(heap_vacio(heap) && heap_tamanio(heap) == 0,
+		     "Un heap recien creado esta vacio.");
+	pa2m_afirmar(heap_raiz(heap) == NULL && heap_extraer_raiz(heap) == NULL,
+		     "Un heap vacio no tiene raiz para devolver.");
+	pa2m_afirmar(heap_insertar(NULL, heap) == NULL,
+		     "No se puede insertar en un heap NULL.");
+	pa2m_afirmar(heap_tamanio(NULL) == 0 && heap_vacio(NULL),
+		     "Un heap NULL no tiene elementos.");
+	heap_destruir(heap);
+}
+
+void pruebas_heap_insertar_y_extraer()
+{
+	int numeros[] = { 7, 3, 9, 1, 5, 3, 8 };
+	heap_t *heap = heap_crear(comparar_enteros, 2);
+	for (size_t i = 0; i < 7; i++)
+		heap_insertar(heap, numeros + i);
+	pa2m_afirmar(heap_tamanio(heap) == 7,
+		     "Se insertan varios elementos (superando la capacidad).");
+	pa2m_afirmar(heap_raiz(heap) == numeros + 3,
+		     "La raiz es el elemento de menor valor.");
+	bool ordenados = true;
+	int anterior = 0;
+	for (size_t i = 0; i < 7; i++) {
+		int actual = *(int *)heap_extraer_raiz(heap);
+		if (actual < anterior)
+			ordenados = false;
+		anterior = actual;
+	}
+	pa2m_afirmar(ordenados,
+		     "Al extraer la raiz repetidamente se obtienen en orden.");
+	pa2m_afirmar(heap_vacio(heap),
+		     "Luego de extraer todos los elementos el heap queda vacio.");
+	heap_destruir(heap);
+}
+
+typedef struct recorrido_enteros {
+	int valores[10];
+	size_t cantidad;
+	size_t limite;
+} recorrido_enteros_t;
+
+bool registrar_entero(void *elemento, void *contexto)
+{
+	recorrido_enteros_t *recorrido = contexto;
+	recorrido->valores[recorrido->cantidad++] = *(int *)elemento;
+	return recorrido->cantidad < recorrido->limite;
+}
+
+void pruebas_heap_desde_vector()
+{
+	int numeros[] = { 4, 8, 2, 6, 0, 9 };
+	void *vector[6];
+	for (size_t i = 0; i < 6; i++)
+		vector[i] = numeros + i;
+	heap_t *heap = heap_crear_desde_vector(comparar_enteros, vector, 6);
+	pa2m_afirmar(heap != NULL && heap_tamanio(heap) == 6,
+		     "Se puede crear un heap a partir de un vector.");
+	pa2m_afirmar(heap_raiz(heap) == numeros + 4,
+		     "La raiz del heap creado es el menor elemento del vector.");
+	heap_destruir(heap);
+}
+
+int enteros_seguidos[6];
+size_t posiciones_seguidas[6];
+
+void guardar_posicion_entero(void *elemento, size_t posicion)
+{
+	posiciones_seguidas[(int *)elemento - enteros_seguidos] = posicion;
+}
+
+void pruebas_heap_posiciones()
+{
+	int valores[] = { 4, 8, 2, 6, 0, 9 };
+	void *vector[6];
+	for (size_t i = 0; i < 6; i++) {
+		enteros_seguidos[i] = valores[i];
+		vector[i] = enteros_seguidos + i;
+	}
+	heap_t *heap = heap_crear_desde_vector(comparar_enteros, vector, 6);
+	heap_seguir_posiciones(heap, guardar_posicion_entero);
+	pa2m_afirmar(posiciones_seguidas[4] == 0,
+		     "Al seguir las posiciones se avisa la de cada elemento.");
+	enteros_seguidos[5] = -1;
+	pa2m_afirmar(heap_reubicar(heap, posiciones_seguidas[5]) &&
+			     heap_raiz(heap) == enteros_seguidos + 5 &&
+			     posiciones_seguidas[5] == 0,
+		     "Se reubica un elemento al bajar su valor.");
+	enteros_seguidos[5] = 7;
+	heap_reubicar(heap, posiciones_seguidas[5]);
+	pa2m_afirmar(heap_raiz(heap) == enteros_seguidos + 4,
+		     "Se reubica un elemento al subir su valor.");
+	pa2m_afirmar(heap_quitar(heap, posiciones_seguidas[2]) ==
+				     enteros_seguidos + 2 &&
+			     heap_tamanio(heap) == 5,
+		     "Se quita un elemento por su posicion.");
+	pa2m_afirmar(heap_quitar(heap, 5) == NULL && !heap_reubicar(heap, 5),
+		     "No se puede quitar ni reubicar una posicion inexistente.");
+	void **reemplazo = malloc(8 * sizeof(void *));
+	for (size_t i = 0; i < 6; i++)
+		reemplazo[i] = enteros_seguidos + 5 - i;
+	pa2m_afirmar(!heap_reemplazar_vector(heap, reemplazo, 9, 8) &&
+			     heap_reemplazar_vector(heap, reemplazo, 6, 8) &&
+			     heap_tamanio(heap) == 6 &&
+			     heap_raiz(heap) == enteros_seguidos + 4 &&
+			     posiciones_seguidas[4] == 0,
+		     "Se reemplaza el vector del heap y se avisan las nuevas "
+		     "posiciones.");
+	bool ordenados = true;
+	int anterior = -1;
+	while (!heap_vacio(heap)) {
+		int *actual = heap_extraer_raiz(heap);
+		if (*actual < anterior)
+			ordenados = false;
+		anterior = *actual;
+	}
+	pa2m_afirmar(ordenados, "Luego de reubicar y quitar, el heap sigue en "
+				"orden.");
+	heap_destruir(heap);
+}
+
+void pruebas_abb_casos_borde()
+{
+	pa2m_afirmar(abb_crear(NULL) == NULL,
+		     "No se puede crear un arbol sin comparador.");
+	abb_t *arbol = abb_crear(comparar_enteros);
+	int numero = 4;
+	size_t posicion = 0;
+	pa2m_afirmar(arbol != NULL && abb_vacio(arbol),
+		     "Se puede crear un arbol vacio.");
+	pa2m_afirmar(abb_elemento_en_posicion(arbol, 0) == NULL &&
+			     !abb_posicion(arbol, &numero, &posicion),
+		     "Un arbol vacio no tiene elementos por posicion.");
+	pa2m_afirmar(abb_quitar(arbol, &numero) == NULL,
+		     "No se puede quitar de un arbol vacio.");
+	abb_insertar(arbol, &numero);
+	pa2m_afirmar(abb_insertar(arbol, &numero) == NULL &&
+			     abb_tamanio(arbol) == 1,
+		     "No se puede insertar dos veces el mismo elemento.");
+	abb_destruir(arbol);
+}
+
+void pruebas_abb_posiciones()
+{
+	int numeros[100];
+	abb_t *arbol = abb_crear(comparar_enteros);
+	for (int i = 0; i < 100; i++) {
+		numeros[i] = (i * 37) % 100;
+		abb_insertar(arbol, numeros + i);
+	}
+	pa2m_afirmar(abb_tamanio(arbol) == 100,
+		     "Se insertan 100 elementos desordenados.");
+	bool seleccion_correcta = true;
+	bool rango_correcto = true;
+	for (int i = 0; i < 100; i++) {
+		int *elemento = abb_elemento_en_posicion(arbol, (size_t)i);
+		size_t posicion = 0;
+		if (!elemento || *elemento != i)
+			seleccion_correcta = false;
+		if (!abb_posicion(arbol, &i, &posicion) ||
+		    posicion != (size_t)i)
+			rango_correcto = false;
+	}
+	pa2m_afirmar(seleccion_correcta,
+		     "Se obtiene cada elemento segun su posicion en orden.");
+	pa2m_afirmar(rango_correcto,
+		     "Se obtiene la posicion en orden de cada elemento.");
+
+	for (int i = 0; i < 100; i += 2)
+		abb_quitar(arbol, &i);
+	int buscado = 51;
+	size_t posicion = 0;
+	pa2m_afirmar(abb_tamanio(arbol) == 50 &&
+			     *(int *)abb_elemento_en_posicion(arbol, 0) == 1 &&
+			     abb_posicion(arbol, &buscado, &posicion) &&
+			     posicion == 25,
+		     "Las posiciones se actualizan al quitar elementos.");
+	int par = 50;
+	pa2m_afirmar(abb_buscar(arbol, &par) == NULL &&
+			     abb_buscar(arbol, &buscado) != NULL,
+		     "Los elementos quitados ya no se encuentran en el arbol.");
+	pa2m_afirmar(abb_cantidad_menores(arbol, &par) == 25 &&
+			     abb_cantidad_menores(arbol, &buscado) == 25,
+		     "Se cuentan los elementos menores a uno que no esta o si.");
+	recorrido_enteros_t recorrido = { .limite = 10 };
+	pa2m_afirmar(abb_con_cada_elemento_en_rango(arbol, 10, 13,
+						    registrar_entero,
+						    &recorrido) == 3 &&
+			     recorrido.valores[0] == 21 &&
+			     recorrido.valores[2] == 25,
+		     "Se recorren solo los elementos de un rango de posiciones.");
+	abb_destruir(arbol);
+}
+
+void pruebas_abb_desde_ordenados_y_recorrido()
+{
+	int numeros[] = { 0, 2, 4, 6, 8, 9 };
+	void *vector[6];
+	for (size_t i = 0; i < 6; i++)
+		vector[i] = numeros + i;
+	abb_t *arbol = abb_crear_desde_ordenados(comparar_enteros, vector, 6);
+	pa2m_afirmar(arbol != NULL && abb_tamanio(arbol) == 6 &&
+			     abb_elemento_en_posicion(arbol, 3) == numeros + 3,
+		     "Se puede crear un arbol a partir de un vector ordenado.");
+	recorrido_enteros_t recorrido = { .limite = 10 };
+	pa2m_afirmar(abb_con_cada_elemento(arbol, registrar_entero,
+					   &recorrido) == 6 &&
+			     recorrido.valores[0] == 0 &&
+			     recorrido.valores[5] == 9,
+		     "El iterador interno recorre el arbol en orden.");
+	recorrido_enteros_t parcial = { .limite = 2 };
+	pa2m_afirmar(abb_con_cada_elemento(arbol, registrar_entero,
+					   &parcial) == 2,
+		     "El iterador interno se detiene cuando la funcion devuelve false.");
+	abb_destruir(arbol);
+}
+
+void pruebas_arena_casos_borde()
+{
+	pa2m_afirmar(arena_crear(0, 10) == NULL,
+		     "No se puede crear una arena de registros de tamaño 0.");
+	pa2m_afirmar(arena_reservar(NULL) == NULL && arena_cantidad(NULL) == 0,
+		     "Una arena inexistente no reserva registros.");
+	arena_t *arena = arena_crear(sizeof(int), 0);
+	int numero = 5;
+	pa2m_afirmar(arena != NULL && arena_cantidad(arena) == 0,
+		     "Se puede crear una arena vacia.");
+	pa2m_afirmar(!arena_contiene(arena, &numero),
+		     "Un puntero externo no pertenece a la arena.");
+	arena_destruir(arena);
+}
+
+void pruebas_arena_reservar_y_liberar()
+{
+	arena_t *arena = arena_crear(sizeof(size_t), 4);
+	size_t *registros[1000];
+	bool ceros = true;
+	for (size_t i = 0; i < 1000; i++) {
+		registros[i] = arena_reservar(arena);
+		ceros = ceros && registros[i] && *registros[i] == 0;
+		if (registros[i])
+			*registros[i] = i;
+	}
+	pa2m_afirmar(arena_cantidad(arena) == 1000 && ceros,
+		     "Se reservan 1000 registros inicializados en cero.");
+	bool intactos = true, contenidos = true;
+	for (size_t i = 0; i < 1000; i++) {
+		intactos = intactos && *registros[i] == i;
+		contenidos = contenidos && arena_contiene(arena, registros[i]);
+	}
+	pa2m_afirmar(intactos,
+		     "Los registros no se pisan al agregar bloques nuevos.");
+	pa2m_afirmar(contenidos,
+		     "Todos los registros reservados pertenecen a la arena.");
+
+	arena_liberar(arena, registros[500]);
+	pa2m_afirmar(arena_cantidad(arena) == 999,
+		     "Liberar un registro descuenta la cantidad.");
+	pa2m_afirmar(arena_reservar(arena) == registros[500] &&
+			     *registros[500] == 0,
+		     "Un registro liberado se reutiliza en la proxima reserva.");
+	arena_destruir(arena);
+}
+
+void pruebas_lector_casos_borde()
+{
+	pa2m_afirmar(lector_crear(-1, 10) == NULL && lector_crear(0, 0) == NULL,
+		     "No se puede crear un lector invalido.");
+	pa2m_afirmar(lector_abrir("ejemplos/noexiste.txt", 10) == NULL,
+		     "No se puede abrir un archivo inexistente.");
+	pa2m_afirmar(lector_leer_linea(NULL, NULL) == NULL,
+		     "Un lector inexistente no devuelve lineas.");
+}
+
+void pruebas_lector_lineas()
+{
+	const char *ruta = "prueba_lector.txt";
+	FILE *archivo = fopen(ruta, "w");
+	fprintf(archivo, "uno\n\n");
+	for (size_t i = 0; i < 100000; i++)
+		fputc('a', archivo);
+	fputc('\n', archivo);
+	for (size_t i = 0; i < 200000; i++)
+		fputc('b', archivo);
+	fprintf(archivo, "\nultima");
+	fclose(archivo);
+
+	lector_t *lector = lector_abrir(ruta, 150000);
+	size_t largo = 0;
+	char *linea = lector_leer_linea(lector, &largo);
+	pa2m_afirmar(linea && strcmp(linea, "uno") == 0 && largo == 3,
+		     "Se lee la primera linea sin el salto de linea.");
+	linea = lector_leer_linea(lector, &largo);
+	pa2m_afirmar(linea && largo == 0, "Se lee una linea vacia.");
+	linea = lector_leer_linea(lector, &largo);
+	pa2m_afirmar(linea && largo == 100000 && linea[0] == 'a' &&
+			     linea[99999] == 'a' && linea[100000] == '\0',
+		     "Se lee una linea mas larga que un bloque de lectura.");
+	pa2m_afirmar(lector_leer_linea(lector, &largo) == NULL &&
+			     lector_hubo_error(lector) &&
+			     lector_linea_demasiado_larga(lector),
+		     "Una linea mas larga que el maximo es un error.");
+	linea = lector_leer_linea(lector, &largo);
+	pa2m_afirmar(linea && strcmp(linea, "ultima") == 0 &&
+			     !lector_hubo_error(lector),
+		     "Luego de una linea demasiado larga se sigue leyendo.");
+	pa2m_afirmar(lector_leer_linea(lector, &largo) == NULL &&
+			     !lector_hubo_error(lector),
+		     "Al final del archivo no hay mas lineas ni errores.");
+	lector_destruir(lector);
+	remove(ruta);
+
+	lector = lector_abrir(".", 10);
+	pa2m_afirmar(lector_leer_linea(lector, &largo) == NULL &&
+			     lector_hubo_error(lector) &&
+			     !lector_linea_demasiado_larga(lector),
+		     "Un error de lectura no se confunde con una linea larga.");
+	lector_destruir(lector);
+}
+
+void pruebas_pokemon_lectura_desde_string()
+{
+	pokemon_t *pokemon = pokemon_crear_desde_string("7, Mew ,+42,Ash");
+	pa2m_afirmar(pokemon && pokemon_id(pokemon) == 7 &&
+			     strcmp(pokemon_nombre(pokemon), " Mew ") == 0 &&
+			     pokemon_salud(pokemon) == 42 &&
+			     strcmp(pokemon_entrenador(pokemon), "Ash") == 0,
+		     "Se lee un pokemon con espacios y signo en los numeros.");
+	pokemon_destruir(pokemon);
+
+	pokemon = pokemon_crear_desde_string("8,Mewtwo,3,Giovanni,sobrante");
+	pa2m_afirmar(pokemon &&
+			     strcmp(pokemon_entrenador(pokemon), "Giovanni") ==
+				     0,
+		     "Se ignora lo que sigue al nombre del entrenador.");
+	pokemon_destruir(pokemon);
+
+	pa2m_afirmar(pokemon_crear_desde_string("1,,10,Ash") == NULL &&
+			     pokemon_crear_desde_string("1,Pikachu,10,") ==
+				     NULL,
+		     "No se puede leer un pokemon con un nombre vacio.");
+	pa2m_afirmar(pokemon_crear_desde_string("x,Pikachu,10,Ash") == NULL &&
+			     pokemon_crear_desde_string("1,Pikachu,-10,Ash") ==
+				     NULL,
+		     "No se puede leer un pokemon con numeros invalidos.");
+	pa2m_afirmar(pokemon_crear_desde_string(
+			     "99999999999999999999999,Pikachu,10,Ash") == NULL,
+		     "No se puede leer un id que no entra en un size_t.");
+	pa2m_afirmar(
+		pokemon_crear_desde_string(
+			"1,Pikachu,10,Entrenador con un nombre demasiado largo") ==
+			NULL,
+		"No se puede leer un nombre que no entra en el pokemon.");
+	pokemon = pokemon_crear_desde_string(
+		"2,Nombre de 29 caracteres xxxxx,10,Ash");
+	pa2m_afirmar(pokemon && strlen(pokemon_nombre(pokemon)) == 29,
+		     "Se lee un nombre del largo maximo.");
+	pokemon_destruir(pokemon);
+}
+
+bool saludes_en_orden(hospital_t *hospital)
+{
+	for (size_t i = 1; i < hospital_cantidad_pokemones(hospital); i++)
+		if (pokemon_salud(hospital_obtener_pokemon(hospital, i - 1)) >
+		    pokemon_salud(hospital_obtener_pokemon(hospital, i)))
+			return false;
+	return true;
+}
+
+void pruebas_hospital_emergencias_intercaladas()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(saludes_en_orden(hospital),
+		     "Los pokemon del hospital se obtienen en orden de salud.");
+
+	pokemon_t *ambulancia1[] = {
+		pokemon_crear_desde_string("20,Eevee,50,Ana"),
+		pokemon_crear_desde_string("21,Ditto,1,Ana"),
+		pokemon_crear_desde_string("22,Onix,20,Luis")
+	};
+	pa2m_afirmar(hospital_aceptar_emergencias(hospital, ambulancia1, 3) ==
+			     EXITO,
+		     "Se aceptan emergencias luego de recorrer el hospital.");
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) == 15 &&
+			     saludes_en_orden(hospital),
+		     "Los pokemon ingresados quedan en orden de salud.");
+	pa2m_afirmar(hospital_obtener_pokemon(hospital, 0) == ambulancia1[1],
+		     "El pokemon de la ambulancia con menos salud pasa al frente.");
+
+	pokemon_t *ambulancia2[] = {
+		pokemon_crear_desde_string("23,Abra,99,Ana"),
+		pokemon_crear_desde_string("24,Zubat,0,Luis")
+	};
+	hospital_aceptar_emergencias(hospital, ambulancia2, 2);
+	pa2m_afirmar(hospital_obtener_pokemon(hospital, 0) == ambulancia2[1] &&
+			     hospital_obtener_pokemon(hospital, 16) ==
+				     ambulancia2[0] &&
+			     saludes_en_orden(hospital),
+		     "Un segundo lote de emergencias tambien queda en orden.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_prioridad_por_id()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	size_t prioridad = 99;
+	pa2m_afirmar(hospital_prioridad_pokemon(NULL, 3, &prioridad) == ERROR &&
+			     hospital_prioridad_pokemon(hospital, 3, NULL) ==
+				     ERROR,
+		     "No se puede consultar la prioridad con parametros NULL.");
+	pa2m_afirmar(hospital_prioridad_pokemon(hospital, 3, &prioridad) ==
+				     EXITO &&
+			     prioridad == 0,
+		     "El pokemon con menos salud tiene prioridad 0.");
+	pa2m_afirmar(hospital_prioridad_pokemon(hospital, 1, &prioridad) ==
+				     EXITO &&
+			     prioridad == 2 &&
+			     hospital_prioridad_pokemon(hospital, 10,
+							&prioridad) == EXITO &&
+			     prioridad == 3,
+		     "A igual salud tiene mas prioridad el que ingreso primero.");
+	pa2m_afirmar(hospital_prioridad_pokemon(hospital, 77, &prioridad) ==
+			     ERROR,
+		     "No se puede consultar la prioridad de un id inexistente.");
+
+	pokemon_t *ambulancia[] = { pokemon_crear_desde_string(
+		"77,Ditto,1,Ana") };
+	hospital_aceptar_emergencias(hospital, ambulancia, 1);
+	pa2m_afirmar(hospital_prioridad_pokemon(hospital, 77, &prioridad) ==
+				     EXITO &&
+			     prioridad == 0 &&
+			     hospital_prioridad_pokemon(hospital, 3,
+							&prioridad) == EXITO &&
+			     prioridad == 1,
+		     "Las prioridades se actualizan al aceptar emergencias.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_carga_grande()
+{
+	const char *ruta = "prueba_carga_grande.txt";
+	FILE *archivo = fopen(ruta, "w");
+	for (size_t i = 0; i < 5000; i++)
+		fprintf(archivo, "%zu,Pokemon%zu,%zu,Entrenador%zu%s", i, i,
+			(i * 7919) % 101, i % 13, (i < 4999) ? "\n" : "");
+	fclose(archivo);
+
+	hospital_t *hospital = hospital_crear_desde_archivo(ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) == 5000,
+		     "Se cargan todas las lineas de un archivo de varios bloques.");
+	pa2m_afirmar(saludes_en_orden(hospital),
+		     "Los pokemon cargados quedan ordenados por salud.");
+	bool estable = true;
+	for (size_t i = 1; i < 5000; i++) {
+		pokemon_t *anterior = hospital_obtener_pokemon(hospital, i - 1);
+		pokemon_t *actual = hospital_obtener_pokemon(hospital, i);
+		if (pokemon_salud(anterior) == pokemon_salud(actual) &&
+		    pokemon_id(anterior) > pokemon_id(actual))
+			estable = false;
+	}
+	pa2m_afirmar(estable,
+		     "A igual salud se conserva el orden de las lineas.");
+	size_t prioridad = 0;
+	pa2m_afirmar(hospital_prioridad_pokemon(hospital, 4999, &prioridad) ==
+			     EXITO,
+		     "Se carga la ultima linea aunque no termine en salto de linea.");
+	hospital_destruir(hospital);
+	remove(ruta);
+}
+
+void pruebas_hospital_carga_saludes_amplias()
+{
+	const char *ruta = "prueba_saludes_amplias.txt";
+	FILE *archivo = fopen(ruta, "w");
+	for (size_t i = 0; i < 1000; i++)
+		fprintf(archivo, "%zu,Pokemon%zu,%zu,Entrenador\n", i, i,
+			((i * 7) % 500) * (size_t)1000000007);
+	fclose(archivo);
+
+	hospital_t *hospital = hospital_crear_desde_archivo(ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) == 1000 &&
+			     saludes_en_orden(hospital),
+		     "Se ordenan pokemon con saludes en un rango muy amplio.");
+	bool estable = true;
+	for (size_t i = 1; i < 1000; i++) {
+		pokemon_t *anterior = hospital_obtener_pokemon(hospital, i - 1);
+		pokemon_t *actual = hospital_obtener_pokemon(hospital, i);
+		if (pokemon_salud(anterior) == pokemon_salud(actual) &&
+		    pokemon_id(anterior) > pokemon_id(actual))
+			estable = false;
+	}
+	pa2m_afirmar(estable,
+		     "A igual salud se conserva el orden de las lineas.");
+	hospital_destruir(hospital);
+	remove(ruta);
+}
+
+void pruebas_hospital_carga_paralela()
+{
+	const char *ruta = "prueba_carga_paralela.txt";
+	hospital_establecer_hilos(3);
+	hospital_establecer_umbral_paralelo(0);
+	FILE *archivo = fopen(ruta, "w");
+	for (size_t i = 0; i < 30000; i++)
+		fprintf(archivo, "%zu,Pokemon%zu,%zu,Entrenador%zu\n", i, i,
+			(i * 7919) % 101, i % 13);
+	fclose(archivo);
+
+	hospital_t *hospital = hospital_crear_desde_archivo(ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) == 30000 &&
+			     saludes_en_orden(hospital),
+		     "Se carga y ordena un archivo grande en varios hilos.");
+	size_t prioridad = 0;
+	bool orden_archivo = true;
+	for (size_t i = 1; i < 30000; i++) {
+		pokemon_t *anterior = hospital_obtener_pokemon(hospital, i - 1);
+		pokemon_t *actual = hospital_obtener_pokemon(hospital, i);
+		if (pokemon_salud(anterior) == pokemon_salud(actual) &&
+		    pokemon_id(anterior) > pokemon_id(actual))
+			orden_archivo = false;
+	}
+	pa2m_afirmar(orden_archivo &&
+			     hospital_prioridad_pokemon(hospital, 29999,
+							&prioridad) == EXITO,
+		     "A igual salud se respeta el orden del archivo.");
+	hospital_destruir(hospital);
+
+	archivo = fopen(ruta, "w");
+	for (size_t i = 0; i < 30000; i++)
+		fprintf(archivo, "%s\n",
+			(i == 15000) ? "linea invalida" : "1,Pikachu,10,Ash");
+	fclose(archivo);
+	pa2m_afirmar(hospital_crear_desde_archivo(ruta) == NULL,
+		     "Una linea invalida en cualquier tramo hace fallar la carga.");
+
+	archivo = fopen(ruta, "w");
+	fclose(archivo);
+	pa2m_afirmar(hospital_crear_desde_archivo(ruta) == NULL,
+		     "No se puede crear un hospital desde un archivo vacio.");
+	hospital_establecer_hilos(0);
+	hospital_establecer_umbral_paralelo(65536);
+	remove(ruta);
+}
+
+void pruebas_hospital_archivo_binario()
+{
+	const char *ruta = "prueba_hospital.bin";
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pokemon_t *ambulancia[] = { pokemon_crear_desde_string(
+		"77,Ditto,1,Ana") };
+	hospital_aceptar_emergencias(hospital, ambulancia, 1);
+	pa2m_afirmar(hospital_guardar_binario(NULL, ruta) == ERROR &&
+			     hospital_guardar_binario(hospital, NULL) == ERROR,
+		     "No se puede guardar un hospital con parametros NULL.");
+	pa2m_afirmar(hospital_guardar_binario(hospital, ruta) == EXITO,
+		     "Se guarda un hospital en un archivo binario.");
+	hospital_t *vacio = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	while (hospital_cantidad_pokemones(vacio) > 0)
+		pokemon_destruir(hospital_atender_siguiente(vacio));
+	pa2m_afirmar(hospital_guardar_binario(vacio, ruta) == ERROR &&
+			     hospital_guardar_binario(
+				     hospital, "inexistente/hospital.bin") ==
+				     ERROR,
+		     "No se guarda un hospital vacio ni en un directorio "
+		     "inexistente.");
+	glob_t temporales = { 0 };
+	pa2m_afirmar(hospital_guardar_binario(hospital, "ejemplos") == ERROR &&
+			     glob("ejemplos.*", 0, NULL, &temporales) ==
+				     GLOB_NOMATCH,
+		     "Si no se puede reemplazar el archivo no queda el archivo "
+		     "temporal.");
+	globfree(&temporales);
+	hospital_destruir(vacio);
+
+	hospital_t *cargado = hospital_cargar_binario(ruta);
+	bool iguales = hospital_cantidad_pokemones(cargado) ==
+		       hospital_cantidad_pokemones(hospital);
+	for (size_t i = 0; iguales && i < hospital_cantidad_pokemones(hospital);
+	     i++) {
+		pokemon_t *original = hospital_obtener_pokemon(hospital, i);
+		pokemon_t *copia = hospital_obtener_pokemon(cargado, i);
+		iguales = pokemon_id(original) == pokemon_id(copia) &&
+			  pokemon_salud(original) == pokemon_salud(copia) &&
+			  strcmp(pokemon_nombre(original),
+				 pokemon_nombre(copia)) == 0 &&
+			  strcmp(pokemon_entrenador(original),
+				 pokemon_entrenador(copia)) == 0;
+	}
+	pa2m_afirmar(iguales,
+		     "Un guardado fallido no pisa el archivo anterior, y el "
+		     "hospital cargado tiene los mismos pokemon en orden.");
+	size_t prioridad = 99;
+	pa2m_afirmar(hospital_prioridad_pokemon(cargado, 77, &prioridad) ==
+				     EXITO &&
+			     prioridad == 0,
+		     "Se puede consultar la prioridad en el hospital cargado.");
+
+	pokemon_t *ambulancia2[] = { pokemon_crear_desde_string(
+		"78,Mew,1,Ana") };
+	hospital_aceptar_emergencias(cargado, ambulancia2, 1);
+	pa2m_afirmar(hospital_obtener_pokemon(cargado, 1) == ambulancia2[0],
+		     "Los nuevos ingresos quedan despues de los ya cargados.");
+	hospital_destruir(cargado);
+	hospital_destruir(hospital);
+
+	FILE *archivo = fopen(ruta, "r+b");
+	fseek(archivo, -1, SEEK_END);
+	fputc('X', archivo);
+	fclose(archivo);
+	pa2m_afirmar(hospital_cargar_binario(ruta) == NULL,
+		     "No se carga un archivo con la suma de verificacion incorrecta.");
+
+	archivo = fopen(ruta, "r+b");
+	fseek(archivo, 0, SEEK_END);
+	fputc(0, archivo);
+	fclose(archivo);
+	pa2m_afirmar(hospital_cargar_binario(ruta) == NULL,
+		     "No se carga un archivo con un tamaño incorrecto.");
+	pa2m_afirmar(hospital_cargar_binario("ejemplos/grande.txt") == NULL &&
+			     hospital_cargar_binario("inexistente.bin") == NULL,
+		     "No se carga un archivo que no es un hospital binario.");
+	remove(ruta);
+}
+
+bool mismos_pokemon(hospital_t *hospital1, hospital_t *hospital2)
+{
+	if (hospital_cantidad_pokemones(hospital1) !=
+	    hospital_cantidad_pokemones(hospital2))
+		return false;
+	for (size_t i = 0; i < hospital_cantidad_pokemones(hospital1); i++) {
+		pokemon_t *pokemon1 = hospital_obtener_pokemon(hospital1, i);
+		pokemon_t *pokemon2 = hospital_obtener_pokemon(hospital2, i);
+		if (!pokemon1 || !pokemon2 ||
+		    pokemon_id(pokemon1) != pokemon_id(pokemon2) ||
+		    pokemon_salud(pokemon1) != pokemon_salud(pokemon2) ||
+		    strcmp(pokemon_nombre(pokemon1), pokemon_nombre(pokemon2)) !=
+			    0 ||
+		    strcmp(pokemon_entrenador(pokemon1),
+			   pokemon_entrenador(pokemon2)) != 0)
+			return false;
+	}
+	return true;
+}
+
+bool contar_pokemon(pokemon_t *pokemon, void *contador)
+{
+	(*(size_t *)contador)++;
+	return pokemon != NULL;
+}
+
+/**
+ * Direccion del ultimo pokemon recorrido y cantidad de veces que la direccion
+ * cambio de un pokemon al siguiente.
+*/
+typedef struct direcciones {
+	pokemon_t *anterior;
+	size_t distintas;
+} direcciones_t;
+
+bool contar_direcciones(pokemon_t *pokemon, void *direcciones)
+{
+	direcciones_t *datos = direcciones;
+	if (pokemon != datos->anterior)
+		datos->distintas++;
+	datos->anterior = pokemon;
+	return true;
+}
+
+void pruebas_hospital_vista_mapeada()
+{
+	const char *ruta = "prueba_hospital_mapeado.bin";
+	pa2m_afirmar(hospital_abrir_mmap(NULL) == NULL &&
+			     hospital_abrir_mmap("inexistente.txt") == NULL,
+		     "No se puede abrir un archivo inexistente.");
+
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_t *vista = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(mismos_pokemon(hospital, vista),
+		     "La vista de un CSV tiene los mismos pokemon en el mismo orden.");
+	pa2m_afirmar(hospital_obtener_pokemon(vista, 3) ==
+				     hospital_obtener_pokemon(vista, 3) &&
+			     hospital_obtener_pokemon(vista, 12) == NULL,
+		     "Cada pokemon se materializa una sola vez.");
+	size_t contador = 0;
+	pa2m_afirmar(hospital_a_cada_pokemon(vista, contar_pokemon,
+					     &contador) == 12 &&
+			     contador == 12,
+		     "Se recorren todos los pokemon de la vista.");
+	direcciones_t direcciones = { 0 };
+	pokemon_t *peores[2];
+	hospital_a_cada_pokemon(vista, contar_direcciones, &direcciones);
+	pa2m_afirmar(direcciones.distintas == 1 &&
+			     hospital_peores_k(vista, 2, peores) == 2 &&
+			     peores[1] == hospital_obtener_pokemon(vista, 1) &&
+			     pokemon_id(peores[0]) ==
+				     pokemon_id(hospital_obtener_pokemon(
+					     hospital, 0)),
+		     "Los recorridos de la vista reutilizan un registro "
+		     "auxiliar, y los pokemon devueltos se materializan.");
+	size_t prioridad = 99;
+	pa2m_afirmar(hospital_prioridad_pokemon(vista, 10, &prioridad) ==
+				     EXITO &&
+			     prioridad == 3 &&
+			     hospital_prioridad_pokemon(vista, 77,
+							&prioridad) == ERROR,
+		     "Se consulta la prioridad de un id en la vista.");
+	pokemon_t *ambulancia[] = { pokemon_crear_desde_string(
+		"77,Ditto,1,Ana") };
+	pa2m_afirmar(hospital_aceptar_emergencias(vista, ambulancia, 1) ==
+			     ERROR,
+		     "No se pueden aceptar emergencias en una vista.");
+	pokemon_destruir(ambulancia[0]);
+
+	pa2m_afirmar(hospital_guardar_binario(vista, ruta) == EXITO,
+		     "Se guarda la vista de un CSV como archivo binario.");
+	hospital_destruir(vista);
+	vista = hospital_abrir_mmap(ruta);
+	pa2m_afirmar(mismos_pokemon(hospital, vista),
+		     "La vista de un archivo binario tiene los mismos pokemon.");
+	pa2m_afirmar(hospital_prioridad_pokemon(vista, 1, &prioridad) ==
+				     EXITO &&
+			     prioridad == 2,
+		     "Se consulta la prioridad de un id en la vista binaria.");
+	hospital_destruir(vista);
+
+	// Intercambia los dos primeros registros (los encabezados ocupan 40
+	// bytes) sin quitar la bandera de archivo ordenado.
+	FILE *archivo = fopen(ruta, "r+b");
+	fseek(archivo, 0, SEEK_END);
+	long registro = (ftell(archivo) - 40) /
+			(long)hospital_cantidad_pokemones(hospital);
+	char primero[256], segundo[256];
+	fseek(archivo, 40, SEEK_SET);
+	fread(primero, (size_t)registro, 1, archivo);
+	fread(segundo, (size_t)registro, 1, archivo);
+	fseek(archivo, 40, SEEK_SET);
+	fwrite(segundo, (size_t)registro, 1, archivo);
+	fwrite(primero, (size_t)registro, 1, archivo);
+	fclose(archivo);
+	pa2m_afirmar(hospital_abrir_mmap(ruta) == NULL,
+		     "No se abre un archivo binario que dice estar ordenado y "
+		     "no lo esta.");
+	hospital_destruir(hospital);
+
+	archivo = fopen(ruta, "w");
+	fprintf(archivo, "1,Pikachu,10,Ash\nlinea invalida\n");
+	fclose(archivo);
+	pa2m_afirmar(hospital_abrir_mmap(ruta) == NULL,
+		     "No se abre un CSV con una linea invalida.");
+	archivo = fopen(ruta, "w");
+	fclose(archivo);
+	pa2m_afirmar(hospital_abrir_mmap(ruta) == NULL,
+		     "No se abre un archivo vacio.");
+	remove(ruta);
+}
+
+void pruebas_hospital_diario()
+{
+	const char *ruta = "prueba_diario.bin";
+	remove(ruta);
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_abrir_diario(NULL, ruta, SINCRONIZAR_NUNCA,
+					   0) == ERROR &&
+			     hospital_abrir_diario(hospital, ruta, 7, 0) ==
+				     ERROR,
+		     "No se puede abrir un diario con parametros invalidos.");
+	pa2m_afirmar(hospital_abrir_diario(hospital, ruta,
+					   SINCRONIZAR_CADA_LOTE, 0) == EXITO,
+		     "Se abre un diario nuevo para el hospital.");
+	pokemon_t *ambulancia1[] = {
+		pokemon_crear_desde_string("20,Eevee,50,Ana"),
+		pokemon_crear_desde_string("21,Ditto,1,Ana")
+	};
+	pokemon_t *ambulancia2[] = { pokemon_crear_desde_string(
+		"22,Onix,1,Luis") };
+	hospital_aceptar_emergencias(hospital, ambulancia1, 2);
+	hospital_aceptar_emergencias(hospital, ambulancia2, 1);
+
+	hospital_t *recuperado =
+		hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(mismos_pokemon(hospital, recuperado),
+		     "Se recupera el hospital con las emergencias del diario.");
+	hospital_destruir(recuperado);
+	hospital_destruir(hospital);
+
+	FILE *archivo = fopen(ruta, "ab");
+	fprintf(archivo, "lote cortado");
+	fclose(archivo);
+	recuperado = hospital_recuperar("ejemplos/grande.txt", ruta);
+	size_t prioridad = 99;
+	pa2m_afirmar(hospital_cantidad_pokemones(recuperado) == 15 &&
+			     hospital_prioridad_pokemon(recuperado, 22,
+							&prioridad) == EXITO &&
+			     prioridad == 1,
+		     "Se ignora un lote incompleto al final del diario.");
+	pa2m_afirmar(hospital_abrir_diario(recuperado, ruta,
+					   SINCRONIZAR_PERIODICAMENTE,
+					   1000) == EXITO,
+		     "Se sigue agregando al diario luego de recuperar.");
+	pokemon_t *ambulancia3[] = { pokemon_crear_desde_string(
+		"23,Mew,0,Ana") };
+	hospital_aceptar_emergencias(recuperado, ambulancia3, 1);
+	hospital_destruir(recuperado);
+	recuperado = hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(recuperado) == 16 &&
+			     pokemon_id(hospital_obtener_pokemon(recuperado,
+								 0)) == 23,
+		     "Los lotes agregados despues de truncar se recuperan.");
+	hospital_destruir(recuperado);
+
+	uint32_t encabezado_lote[] = { 0x45544f4cu, 0, 0, 0x100, 0, 0 };
+	archivo = fopen(ruta, "ab");
+	fwrite(encabezado_lote, sizeof(encabezado_lote), 1, archivo);
+	fclose(archivo);
+	recuperado = hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(recuperado) == 16,
+		     "Se ignora un lote que dice tener mas pokemon de los que "
+		     "entran en el diario.");
+	hospital_destruir(recuperado);
+
+	pa2m_afirmar(hospital_recuperar("ejemplos/grande.txt",
+					"ejemplos/grande.txt") == NULL,
+		     "No se recupera con un archivo que no es un diario.");
+	remove(ruta);
+	recuperado = hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(hospital_cantidad_pokemones(recuperado) == 12,
+		     "Sin diario se recupera solo el archivo base.");
+	hospital_destruir(recuperado);
+}
+
+void pruebas_hospital_indices_secundarios()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_buscar_por_id(NULL, 1) == NULL &&
+			     hospital_buscar_por_nombre(hospital, NULL) ==
+				     NULL &&
+			     hospital_a_cada_pokemon_de_entrenador(
+				     hospital, NULL, contar_pokemon, NULL) == 0,
+		     "No se puede buscar con parametros NULL.");
+	pokemon_t *pokemon = hospital_buscar_por_id(hospital, 6);
+	pa2m_afirmar(pokemon && strcmp(pokemon_nombre(pokemon), "Snorlax") == 0,
+		     "Se busca un pokemon por id.");
+	pokemon = hospital_buscar_por_nombre(hospital, "Voltorb");
+	pa2m_afirmar(pokemon && pokemon_id(pokemon) == 9 &&
+			     hospital_buscar_por_nombre(hospital, "Ditto") ==
+				     NULL,
+		     "Se busca un pokemon por nombre.");
+	size_t contador = 0;
+	pa2m_afirmar(hospital_a_cada_pokemon_de_entrenador(
+			     hospital, "Lucas", contar_pokemon, &contador) ==
+				     4 &&
+			     contador == 4,
+		     "Se recorren los pokemon de un entrenador.");
+
+	pokemon_t *ambulancia[] = {
+		pokemon_crear_desde_string("20,Ditto,1,Lucas"),
+		pokemon_crear_desde_string("21,Voltorb,5,Ana")
+	};
+	hospital_aceptar_emergencias(hospital, ambulancia, 2);
+	contador = 0;
+	pa2m_afirmar(hospital_buscar_por_id(hospital, 20) == ambulancia[0] &&
+			     hospital_buscar_por_nombre(hospital, "Ditto") ==
+				     ambulancia[0] &&
+			     hospital_a_cada_pokemon_de_entrenador(
+				     hospital, "Lucas", contar_pokemon,
+				     &contador) == 5,
+		     "Los indices se actualizan al aceptar emergencias.");
+	pa2m_afirmar(pokemon_id(hospital_buscar_por_nombre(
+			     hospital, "Voltorb")) == 9,
+		     "Con nombres repetidos se encuentra el que ingreso primero.");
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	contador = 0;
+	pa2m_afirmar(pokemon_id(hospital_buscar_por_id(hospital, 6)) == 6 &&
+			     pokemon_id(hospital_buscar_por_nombre(
+				     hospital, "Voltorb")) == 9 &&
+			     hospital_a_cada_pokemon_de_entrenador(
+				     hospital, "Abril", contar_pokemon,
+				     &contador) == 4,
+		     "Se busca en la vista de un archivo mapeado.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_peores_k()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pokemon_t *peores[20] = { NULL };
+	pa2m_afirmar(hospital_peores_k(NULL, 3, peores) == 0 &&
+			     hospital_peores_k(hospital, 3, NULL) == 0 &&
+			     hospital_peores_k(hospital, 0, peores) == 0,
+		     "No se obtienen pokemon con parametros invalidos o k 0.");
+	pa2m_afirmar(hospital_peores_k(hospital, 3, peores) == 3 &&
+			     pokemon_id(peores[0]) == 3 &&
+			     pokemon_id(peores[1]) == 4 &&
+			     pokemon_id(peores[2]) == 1 && peores[3] == NULL,
+		     "Se obtienen los k pokemon con menos salud en orden.");
+	pa2m_afirmar(pokemon_id(hospital_obtener_pokemon(hospital, 0)) == 3 &&
+			     hospital_cantidad_pokemones(hospital) == 12,
+		     "Obtener los peores pokemon no modifica el hospital.");
+	pa2m_afirmar(hospital_peores_k(hospital, 20, peores) == 12 &&
+			     pokemon_id(peores[11]) == 11,
+		     "Con k mayor a la cantidad se obtienen todos los pokemon.");
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_peores_k(hospital, 2, peores) == 2 &&
+			     pokemon_id(peores[0]) == 3 &&
+			     pokemon_id(peores[1]) == 4,
+		     "Se obtienen los peores pokemon de un archivo mapeado.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_atender_y_actualizar()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_atender_siguiente(NULL) == NULL &&
+			     hospital_actualizar_salud(NULL, 1, 5) == ERROR &&
+			     hospital_actualizar_salud(hospital, 40, 5) ==
+				     ERROR,
+		     "No se atiende ni actualiza con parametros invalidos.");
+	hospital_buscar_por_id(hospital, 1);
+	hospital_buscar_por_nombre(hospital, "Pikachu");
+	pokemon_t *atendido = hospital_atender_siguiente(hospital);
+	pa2m_afirmar(atendido && pokemon_id(atendido) == 3 &&
+			     hospital_cantidad_pokemones(hospital) == 11 &&
+			     pokemon_id(hospital_obtener_pokemon(hospital, 0)) ==
+				     4,
+		     "Se atiende al pokemon con menos salud.");
+	pokemon_destruir(atendido);
+	size_t contador = 0;
+	hospital_a_cada_pokemon_de_entrenador(hospital, "Nico", contar_pokemon,
+					      &contador);
+	pa2m_afirmar(hospital_buscar_por_id(hospital, 3) == NULL &&
+			     hospital_buscar_por_nombre(hospital, "Jynx") ==
+				     NULL &&
+			     contador == 3,
+		     "El pokemon atendido se quita de los indices.");
+
+	size_t prioridad = 99;
+	pa2m_afirmar(hospital_actualizar_salud(hospital, 5, 1) == EXITO &&
+			     hospital_prioridad_pokemon(hospital, 5,
+							&prioridad) == EXITO &&
+			     prioridad == 0 &&
+			     pokemon_id(hospital_obtener_pokemon(hospital, 0)) ==
+				     5,
+		     "Al bajar la salud de un pokemon sube su prioridad.");
+	pa2m_afirmar(hospital_actualizar_salud(hospital, 5, 100) == EXITO &&
+			     pokemon_id(hospital_obtener_pokemon(hospital,
+								 10)) == 5,
+		     "Al subir la salud de un pokemon baja su prioridad.");
+	pa2m_afirmar(hospital_actualizar_salud(hospital, 12, 20) == EXITO &&
+			     hospital_prioridad_pokemon(hospital, 12,
+							&prioridad) == EXITO &&
+			     prioridad == 3,
+		     "A igual salud se respeta el orden de ingreso original.");
+
+	pokemon_t *ambulancia[] = {
+		pokemon_crear_desde_string("20,Ditto,0,Ana"),
+		pokemon_crear_desde_string("4,Onix,50,Ana")
+	};
+	hospital_aceptar_emergencias(hospital, ambulancia, 2);
+	atendido = hospital_atender_siguiente(hospital);
+	pa2m_afirmar(atendido == ambulancia[0],
+		     "Un pokemon de emergencias se entrega tal cual.");
+	pokemon_destruir(atendido);
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	pa2m_afirmar(hospital_buscar_por_id(hospital, 4) == ambulancia[1],
+		     "Con ids repetidos, al atender uno se encuentra el otro.");
+	while ((atendido = hospital_atender_siguiente(hospital)))
+		pokemon_destruir(atendido);
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) == 0 &&
+			     hospital_obtener_pokemon(hospital, 0) == NULL,
+		     "Se atiende a todos los pokemon hasta vaciar el hospital.");
+	hospital_destruir(hospital);
+
+	const char *ruta = "prueba_diario_atenciones.bin";
+	remove(ruta);
+	hospital = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_abrir_diario(hospital, ruta, SINCRONIZAR_NUNCA, 0);
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	hospital_actualizar_salud(hospital, 11, 3);
+	hospital_actualizar_salud(hospital, 1, 90);
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	hospital_t *recuperado =
+		hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(mismos_pokemon(hospital, recuperado),
+		     "Se recuperan del diario las atenciones y cambios de salud.");
+	hospital_destruir(recuperado);
+	hospital_destruir(hospital);
+	remove(ruta);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_atender_siguiente(hospital) == NULL &&
+			     hospital_actualizar_salud(hospital, 1, 5) == ERROR,
+		     "No se atiende ni actualiza la vista de un archivo.");
+	hospital_destruir(hospital);
+}
+
+#define PRODUCTORES_PRUEBA 4
+#define LOTES_POR_PRODUCTOR 250
+
+void *producir_emergencias(void *cola)
+{
+	for (size_t i = 0; i < LOTES_POR_PRODUCTOR; i++) {
+		pokemon_t *lote[] = {
+			pokemon_crear_desde_string("30,Ditto,5,Ana"),
+			pokemon_crear_desde_string("31,Onix,50,Luis")
+		};
+		cola_emergencias_encolar(cola, lote, 2);
+	}
+	return NULL;
+}
+
+void pruebas_hospital_cola_emergencias()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	cola_emergencias_t *cola = cola_emergencias_crear();
+	pokemon_t *lote1[] = { pokemon_crear_desde_string("20,Ditto,1,Ana") };
+	pokemon_t *lote2[] = { pokemon_crear_desde_string("21,Onix,0,Luis"),
+			       pokemon_crear_desde_string("22,Mew,50,Luis") };
+	pa2m_afirmar(cola_emergencias_encolar(NULL, lote1, 1) == ERROR &&
+			     cola_emergencias_drenar(cola, NULL) == ERROR,
+		     "No se encola ni drena con parametros NULL.");
+	pa2m_afirmar(cola_emergencias_encolar(cola, lote1, 1) == EXITO &&
+			     cola_emergencias_encolar(cola, lote2, 2) == EXITO,
+		     "Se encolan lotes de emergencias.");
+	metricas_cola_t metricas;
+	cola_emergencias_metricas(cola, &metricas);
+	pa2m_afirmar(metricas.lotes_pendientes == 2 &&
+			     metricas.pokemon_pendientes == 3 &&
+			     hospital_cantidad_pokemones(hospital) == 12,
+		     "Los lotes encolados quedan pendientes hasta drenar.");
+	pa2m_afirmar(cola_emergencias_drenar(cola, hospital) == EXITO &&
+			     hospital_cantidad_pokemones(hospital) == 15 &&
+			     pokemon_id(hospital_obtener_pokemon(hospital, 0)) ==
+				     21,
+		     "Al drenar, los lotes ingresan al hospital.");
+	cola_emergencias_metricas(cola, &metricas);
+	pa2m_afirmar(metricas.lotes_pendientes == 0 &&
+			     metricas.pokemon_pendientes == 0 &&
+			     metricas.lotes_ingresados == 2 &&
+			     metricas.pokemon_ingresados == 3,
+		     "Las metricas reflejan lo ingresado.");
+
+	pthread_t productores[PRODUCTORES_PRUEBA];
+	for (size_t i = 0; i < PRODUCTORES_PRUEBA; i++)
+		pthread_create(&productores[i], NULL, producir_emergencias,
+			       cola);
+	for (size_t i = 0; i < 100; i++)
+		cola_emergencias_drenar(cola, hospital);
+	for (size_t i = 0; i < PRODUCTORES_PRUEBA; i++)
+		pthread_join(productores[i], NULL);
+	cola_emergencias_drenar(cola, hospital);
+	cola_emergencias_metricas(cola, &metricas);
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) ==
+				     15 + PRODUCTORES_PRUEBA *
+						  LOTES_POR_PRODUCTOR * 2 &&
+			     metricas.pokemon_pendientes == 0 &&
+			     metricas.lotes_ingresados ==
+				     2 + PRODUCTORES_PRUEBA *
+						 LOTES_POR_PRODUCTOR,
+		     "Ingresan todos los lotes de varios productores a la vez.");
+
+	pokemon_t *pendiente[] = { pokemon_crear_desde_string(
+		"23,Eevee,3,Ana") };
+	cola_emergencias_encolar(cola, pendiente, 1);
+	cola_emergencias_destruir(cola);
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	cola = cola_emergencias_crear();
+	pokemon_t *rechazado[] = { pokemon_crear_desde_string(
+		"24,Eevee,3,Ana") };
+	cola_emergencias_encolar(cola, rechazado, 1);
+	int resultado = cola_emergencias_drenar(cola, hospital);
+	cola_emergencias_metricas(cola, &metricas);
+	pa2m_afirmar(resultado == ERROR && metricas.pokemon_pendientes == 1,
+		     "Si el hospital no acepta el lote, queda en la cola.");
+	cola_emergencias_destruir(cola);
+	hospital_destruir(hospital);
+}
+
+#define LECTORES_PRUEBA 4
+#define RECORRIDOS_POR_LECTOR 50
+#define LOTES_ESCRITOR 200
+#define GUARDADOS_POR_HILO 20
+#define POKEMON_INSTANTANEA_GRANDE 10000
+
+/**
+ * Estado de un lector de la prueba concurrente: cuenta los pokemon que
+ * encontro fuera de orden y las busquedas de Celebi que fallaron.
+*/
+typedef struct lector_prueba {
+	hospital_t *hospital;
+	size_t errores;
+	size_t salud_anterior;
+} lector_prueba_t;
+
+bool verificar_orden(pokemon_t *pokemon, void *lector)
+{
+	lector_prueba_t *datos = lector;
+	if (pokemon_salud(pokemon) < datos->salud_anterior)
+		datos->errores++;
+	datos->salud_anterior = pokemon_salud(pokemon);
+	return true;
+}
+
+void *recorrer_hospital(void *lector)
+{
+	lector_prueba_t *datos = lector;
+	for (size_t i = 0; i < RECORRIDOS_POR_LECTOR; i++) {
+		datos->salud_anterior = 0;
+		hospital_a_cada_pokemon(datos->hospital, verificar_orden,
+					datos);
+		if (!hospital_buscar_por_nombre(datos->hospital, "Celebi"))
+			datos->errores++;
+		instantanea_t *instantanea =
+			hospital_instantanea(datos->hospital);
+		datos->salud_anterior = 0;
+		instantanea_a_cada_pokemon(instantanea, verificar_orden, datos);
+		instantanea_liberar(instantanea);
+	}
+	return NULL;
+}
+
+void *aceptar_en_paralelo(void *hospital)
+{
+	for (size_t i = 0; i < LOTES_ESCRITOR; i++) {
+		pokemon_t *lote[] = {
+			pokemon_crear_desde_string("40,Ditto,5,Ana"),
+			pokemon_crear_desde_string("41,Onix,50,Luis")
+		};
+		hospital_aceptar_emergencias(hospital, lote, 2);
+	}
+	return NULL;
+}
+
+void *guardar_en_paralelo(void *guardador)
+{
+	lector_prueba_t *datos = guardador;
+	for (size_t i = 0; i < GUARDADOS_POR_HILO; i++)
+		if (hospital_guardar_binario(datos->hospital,
+					     "prueba_concurrente.bin") != EXITO)
+			datos->errores++;
+	return NULL;
+}
+
+void pruebas_hospital_concurrente()
+{
+	hospital_t *vista = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_habilitar_concurrencia(NULL) == ERROR &&
+			     hospital_habilitar_concurrencia(vista) == ERROR,
+		     "No se habilita la concurrencia de NULL ni de una vista.");
+	hospital_destruir(vista);
+
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_habilitar_concurrencia(hospital) == EXITO &&
+			     hospital_habilitar_concurrencia(hospital) == EXITO,
+		     "Se habilita la concurrencia de un hospital.");
+	pokemon_t *celebi[] = { pokemon_crear_desde_string(
+		"42,Celebi,70,Luis") };
+	pa2m_afirmar(hospital_aceptar_emergencias(hospital, celebi, 1) ==
+				     EXITO &&
+			     hospital_cantidad_pokemones(hospital) == 13 &&
+			     hospital_buscar_por_id(hospital, 42) == celebi[0],
+		     "Un hospital concurrente funciona igual desde un hilo.");
+
+	lector_prueba_t lectores[LECTORES_PRUEBA];
+	pthread_t hilos[LECTORES_PRUEBA];
+	pthread_t escritor;
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		lectores[i] = (lector_prueba_t){ .hospital = hospital };
+		pthread_create(&hilos[i], NULL, recorrer_hospital,
+			       &lectores[i]);
+	}
+	pthread_create(&escritor, NULL, aceptar_en_paralelo, hospital);
+	size_t errores = 0;
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		pthread_join(hilos[i], NULL);
+		errores += lectores[i].errores;
+	}
+	pthread_join(escritor, NULL);
+	pa2m_afirmar(errores == 0,
+		     "Varios lectores recorren el hospital mientras ingresan "
+		     "emergencias y siempre lo ven en orden.");
+	pa2m_afirmar(hospital_cantidad_pokemones(hospital) ==
+			     13 + LOTES_ESCRITOR * 2,
+		     "Ingresan todas las emergencias aceptadas en paralelo.");
+
+	errores = 0;
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		lectores[i] = (lector_prueba_t){ .hospital = hospital };
+		pthread_create(&hilos[i], NULL, guardar_en_paralelo,
+			       &lectores[i]);
+	}
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		pthread_join(hilos[i], NULL);
+		errores += lectores[i].errores;
+	}
+	hospital_t *guardado = hospital_cargar_binario("prueba_concurrente.bin");
+	pa2m_afirmar(errores == 0 && mismos_pokemon(hospital, guardado),
+		     "Varios hilos guardan el hospital en el mismo archivo a "
+		     "la vez y el archivo queda completo.");
+	hospital_destruir(guardado);
+	remove("prueba_concurrente.bin");
+	hospital_destruir(hospital);
+}
+
+/**
+ * Recorrido de una instantanea que acepta una emergencia en el hospital por
+ * cada pokemon recorrido.
+*/
+bool aceptar_durante_recorrido(pokemon_t *pokemon, void *hospital)
+{
+	pokemon_t *lote[] = { pokemon_copiar(pokemon) };
+	return hospital_aceptar_emergencias(hospital, lote, 1) == EXITO;
+}
+
+void *tomar_instantaneas(void *lector)
+{
+	lector_prueba_t *datos = lector;
+	for (size_t i = 0; i < RECORRIDOS_POR_LECTOR; i++) {
+		instantanea_t *instantanea =
+			hospital_instantanea(datos->hospital);
+		size_t cantidad = instantanea_cantidad(instantanea);
+		if (cantidad < POKEMON_INSTANTANEA_GRANDE ||
+		    cantidad > POKEMON_INSTANTANEA_GRANDE + LOTES_ESCRITOR * 2)
+			datos->errores++;
+		datos->salud_anterior = 0;
+		if (instantanea_a_cada_pokemon(instantanea, verificar_orden,
+					       datos) != cantidad)
+			datos->errores++;
+		instantanea_liberar(instantanea);
+	}
+	return NULL;
+}
+
+void pruebas_hospital_instantaneas_grandes()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	while (hospital_cantidad_pokemones(hospital) > 0)
+		pokemon_destruir(hospital_atender_siguiente(hospital));
+	char linea[64];
+	for (size_t i = 0; i < POKEMON_INSTANTANEA_GRANDE; i++) {
+		snprintf(linea, sizeof(linea), "%zu,Grande,%zu,Ana", 100 + i,
+			 (i * 7919) % 1000);
+		pokemon_t *lote[] = { pokemon_crear_desde_string(linea) };
+		hospital_aceptar_emergencias(hospital, lote, 1);
+	}
+	hospital_habilitar_concurrencia(hospital);
+	lector_prueba_t lectores[LECTORES_PRUEBA];
+	pthread_t hilos[LECTORES_PRUEBA];
+	pthread_t escritor;
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		lectores[i] = (lector_prueba_t){ .hospital = hospital };
+		pthread_create(&hilos[i], NULL, tomar_instantaneas,
+			       &lectores[i]);
+	}
+	pthread_create(&escritor, NULL, aceptar_en_paralelo, hospital);
+	size_t errores = 0;
+	for (size_t i = 0; i < LECTORES_PRUEBA; i++) {
+		pthread_join(hilos[i], NULL);
+		errores += lectores[i].errores;
+	}
+	pthread_join(escritor, NULL);
+	pa2m_afirmar(errores == 0,
+		     "Las instantaneas de un hospital grande que se copian de a "
+		     "bloques mientras ingresan emergencias estan completas y "
+		     "en orden.");
+	instantanea_t *instantanea = hospital_instantanea(hospital);
+	pa2m_afirmar(instantanea_cantidad(instantanea) ==
+			     POKEMON_INSTANTANEA_GRANDE + LOTES_ESCRITOR * 2,
+		     "Terminadas las emergencias, la instantanea las incluye "
+		     "a todas.");
+	instantanea_liberar(instantanea);
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_instantaneas()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_instantanea(NULL) == NULL &&
+			     instantanea_cantidad(NULL) == 0 &&
+			     instantanea_obtener_pokemon(NULL, 0) == NULL,
+		     "No se crean ni consultan instantaneas NULL.");
+	instantanea_t *primera = hospital_instantanea(hospital);
+	instantanea_t *segunda = hospital_instantanea(hospital);
+	pa2m_afirmar(primera && primera == segunda &&
+			     instantanea_cantidad(primera) == 12 &&
+			     pokemon_id(instantanea_obtener_pokemon(primera,
+								    0)) == 3 &&
+			     instantanea_obtener_pokemon(primera, 12) == NULL,
+		     "Sin modificaciones, las instantaneas comparten la version "
+		     "actual del hospital.");
+
+	pokemon_t *lote[] = { pokemon_crear_desde_string("20,Ditto,1,Ana") };
+	hospital_aceptar_emergencias(hospital, lote, 1);
+	hospital_actualizar_salud(hospital, 3, 90);
+	pokemon_t *atendido = hospital_atender_siguiente(hospital);
+	pokemon_destruir(atendido);
+	instantanea_t *tercera = hospital_instantanea(hospital);
+	pa2m_afirmar(tercera != primera && instantanea_cantidad(tercera) == 12 &&
+			     pokemon_id(instantanea_obtener_pokemon(tercera,
+								    0)) == 4,
+		     "Despues de modificar el hospital se crea una version nueva.");
+	pa2m_afirmar(instantanea_cantidad(primera) == 12 &&
+			     pokemon_id(instantanea_obtener_pokemon(primera,
+								    0)) == 3 &&
+			     pokemon_salud(instantanea_obtener_pokemon(primera,
+								       0)) == 2,
+		     "La version anterior no cambia al modificar el hospital.");
+
+	pa2m_afirmar(instantanea_a_cada_pokemon(tercera,
+						aceptar_durante_recorrido,
+						hospital) == 12 &&
+			     hospital_cantidad_pokemones(hospital) == 24 &&
+			     instantanea_cantidad(tercera) == 12,
+		     "Se puede modificar el hospital mientras se recorre una "
+		     "instantanea.");
+	instantanea_liberar(primera);
+	instantanea_liberar(segunda);
+	hospital_destruir(hospital);
+	pa2m_afirmar(pokemon_id(instantanea_obtener_pokemon(tercera, 0)) == 4,
+		     "Una instantanea sigue siendo valida despues de destruir "
+		     "el hospital.");
+	instantanea_liberar(tercera);
+}
+
+/**
+ * Devuelve true si el entrenador tiene en el hospital la cantidad de pokemon,
+ * la salud minima y la salud promedio indicadas.
+*/
+bool estadisticas_son(hospital_t *hospital, const char *entrenador,
+		      size_t cantidad, size_t minima, double promedio)
+{
+	estadisticas_entrenador_t estadisticas;
+	if (hospital_estadisticas_entrenador(hospital, entrenador,
+					     &estadisticas) == ERROR)
+		return false;
+	double diferencia = estadisticas.salud_promedio - promedio;
+	return estadisticas.cantidad == cantidad &&
+	       estadisticas.salud_minima == minima && diferencia < 0.001 &&
+	       diferencia > -0.001;
+}
+
+void pruebas_hospital_estadisticas_entrenador()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	estadisticas_entrenador_t estadisticas;
+	pa2m_afirmar(hospital_estadisticas_entrenador(NULL, "Lucas",
+						      &estadisticas) == ERROR &&
+			     hospital_estadisticas_entrenador(
+				     hospital, "Ash", &estadisticas) == ERROR &&
+			     hospital_cantidad_entrenadores(NULL) == 0,
+		     "No hay estadisticas de un hospital NULL ni de un "
+		     "entrenador sin pokemon.");
+	pa2m_afirmar(hospital_cantidad_entrenadores(hospital) == 3 &&
+			     estadisticas_son(hospital, "Lucas", 4, 19, 22.75) &&
+			     estadisticas_son(hospital, "Abril", 4, 35, 80) &&
+			     estadisticas_son(hospital, "Nico", 4, 2, 43),
+		     "Se calculan las estadisticas de cada entrenador al "
+		     "cargar el archivo.");
+
+	pokemon_t *lote[] = { pokemon_crear_desde_string("20,Ditto,1,Ana"),
+			      pokemon_crear_desde_string("21,Onix,7,Nico") };
+	hospital_aceptar_emergencias(hospital, lote, 2);
+	pa2m_afirmar(hospital_cantidad_entrenadores(hospital) == 4 &&
+			     estadisticas_son(hospital, "Ana", 1, 1, 1) &&
+			     estadisticas_son(hospital, "Nico", 5, 2, 35.8),
+		     "Las estadisticas se actualizan al aceptar emergencias.");
+
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	pa2m_afirmar(hospital_cantidad_entrenadores(hospital) == 3 &&
+			     hospital_estadisticas_entrenador(
+				     hospital, "Ana", &estadisticas) == ERROR &&
+			     estadisticas_son(hospital, "Nico", 4, 7, 44.25),
+		     "Al atender pokemon se actualizan el minimo y el "
+		     "promedio de su entrenador.");
+
+	hospital_actualizar_salud(hospital, 4, 50);
+	pa2m_afirmar(estadisticas_son(hospital, "Lucas", 4, 20, 30.5),
+		     "Si el pokemon con la salud minima mejora, se recalcula "
+		     "el minimo.");
+	hospital_actualizar_salud(hospital, 1, 5);
+	pa2m_afirmar(estadisticas_son(hospital, "Lucas", 4, 5, 26.75),
+		     "Si un pokemon empeora, puede pasar a tener la salud "
+		     "minima.");
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_cantidad_entrenadores(hospital) == 3 &&
+			     estadisticas_son(hospital, "Nico", 4, 2, 43),
+		     "Una vista calcula las estadisticas recorriendo sus "
+		     "pokemon.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_distribucion_de_salud()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	size_t salud = 0;
+	double promedio = 0;
+	pa2m_afirmar(hospital_percentil_salud(NULL, 50, &salud) == ERROR &&
+			     hospital_percentil_salud(hospital, 101, &salud) ==
+				     ERROR &&
+			     hospital_percentil_salud(hospital, -1, &salud) ==
+				     ERROR &&
+			     hospital_salud_promedio(NULL, &promedio) == ERROR,
+		     "No se calculan percentiles invalidos ni de un hospital "
+		     "NULL.");
+	pa2m_afirmar(hospital_percentil_salud(hospital, 50, &salud) == EXITO &&
+			     salud == 32,
+		     "La mediana es la salud del sexto de 12 pokemon.");
+	pa2m_afirmar(hospital_percentil_salud(hospital, 90, &salud) == EXITO &&
+			     salud == 98,
+		     "El percentil 90 es la salud del undecimo de 12 pokemon.");
+	pa2m_afirmar(hospital_salud_minima(hospital, &salud) == EXITO &&
+			     salud == 2 &&
+			     hospital_salud_maxima(hospital, &salud) == EXITO &&
+			     salud == 99,
+		     "Se obtienen la salud minima y la maxima.");
+	pa2m_afirmar(hospital_contar_salud_menor_a(hospital, 20) == 2 &&
+			     hospital_contar_salud_menor_a(hospital, 21) == 4 &&
+			     hospital_contar_salud_menor_a(hospital, 0) == 0,
+		     "Se cuentan los pokemon con salud menor a un valor.");
+	pa2m_afirmar(hospital_salud_promedio(hospital, &promedio) == EXITO &&
+			     promedio > 48.58 && promedio < 48.59,
+		     "Se calcula la salud promedio.");
+
+	pokemon_t *lote[] = { pokemon_crear_desde_string("20,Ditto,100,Ana") };
+	hospital_aceptar_emergencias(hospital, lote, 1);
+	pokemon_destruir(hospital_atender_siguiente(hospital));
+	hospital_actualizar_salud(hospital, 4, 1);
+	pa2m_afirmar(hospital_salud_minima(hospital, &salud) == EXITO &&
+			     salud == 1 &&
+			     hospital_salud_maxima(hospital, &salud) == EXITO &&
+			     salud == 100 &&
+			     hospital_salud_promedio(hospital, &promedio) ==
+				     EXITO &&
+			     promedio == 663.0 / 12,
+		     "Las saludes se actualizan al ingresar, atender y "
+		     "cambiar la salud de pokemon.");
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_percentil_salud(hospital, 50, &salud) == EXITO &&
+			     salud == 32 &&
+			     hospital_salud_promedio(hospital, &promedio) ==
+				     EXITO &&
+			     promedio > 48.58 && promedio < 48.59,
+		     "Una vista calcula percentiles y el promedio.");
+	hospital_destruir(hospital);
+}
+
+#define POKEMON_RECORRIDO_PARALELO 40000
+#define HILOS_PRUEBA 4
+
+/**
+ * Resultado parcial de un hilo del recorrido paralelo: la suma de saludes,
+ * la cantidad de pokemon y los que encontro fuera de orden en su tramo.
+*/
+typedef struct suma_saludes {
+	size_t suma;
+	size_t cantidad;
+	size_t desordenados;
+	size_t salud_anterior;
+} suma_saludes_t;
+
+bool sumar_salud(pokemon_t *pokemon, void *suma)
+{
+	suma_saludes_t *datos = suma;
+	if (pokemon_salud(pokemon) < datos->salud_anterior)
+		datos->desordenados++;
+	datos->salud_anterior = pokemon_salud(pokemon);
+	datos->suma += pokemon_salud(pokemon);
+	datos->cantidad++;
+	return true;
+}
+
+void combinar_sumas(void *suma, void *suma_hilo)
+{
+	suma_saludes_t *total = suma;
+	suma_saludes_t *parcial = suma_hilo;
+	total->suma += parcial->suma;
+	total->cantidad += parcial->cantidad;
+	total->desordenados += parcial->desordenados;
+}
+
+bool cortar_recorrido(pokemon_t *pokemon, void *aux)
+{
+	return false;
+}
+
+void pruebas_hospital_recorrido_paralelo()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	char linea[64];
+	size_t suma_esperada = 20 + 35 + 2 + 19 + 98 + 65 + 32 + 88 + 29 + 20 +
+			       99 + 76;
+	for (size_t i = 0; i < POKEMON_RECORRIDO_PARALELO; i++) {
+		size_t salud = (i * 7919) % 1000;
+		suma_esperada += salud;
+		snprintf(linea, sizeof(linea), "%zu,Paralelo,%zu,Ana", 100 + i,
+			 salud);
+		pokemon_t *lote[] = { pokemon_crear_desde_string(linea) };
+		hospital_aceptar_emergencias(hospital, lote, 1);
+	}
+	size_t total = POKEMON_RECORRIDO_PARALELO + 12;
+
+	suma_saludes_t sumas[HILOS_PRUEBA] = { { 0 } };
+	void *aux[HILOS_PRUEBA];
+	for (size_t i = 0; i < HILOS_PRUEBA; i++)
+		aux[i] = &sumas[i];
+	pa2m_afirmar(hospital_a_cada_pokemon_paralelo(NULL, sumar_salud, aux,
+						      HILOS_PRUEBA,
+						      NULL) == 0 &&
+			     hospital_a_cada_pokemon_paralelo(
+				     hospital, sumar_salud, aux, 0, NULL) == 0,
+		     "No se recorre un hospital NULL ni con 0 hilos.");
+	pa2m_afirmar(hospital_a_cada_pokemon_paralelo(hospital, sumar_salud,
+						      aux, HILOS_PRUEBA,
+						      combinar_sumas) ==
+				     total &&
+			     sumas[0].cantidad == total &&
+			     sumas[0].suma == suma_esperada,
+		     "El recorrido paralelo visita cada pokemon una vez y "
+		     "combina los resultados de los hilos.");
+	pa2m_afirmar(sumas[0].desordenados == 0 && sumas[1].cantidad > 0 &&
+			     sumas[HILOS_PRUEBA - 1].cantidad > 0,
+		     "Cada hilo recorre en orden un tramo distinto.");
+
+	pa2m_afirmar(hospital_a_cada_pokemon_paralelo(hospital,
+						      cortar_recorrido, aux,
+						      HILOS_PRUEBA,
+						      NULL) <= HILOS_PRUEBA,
+		     "Si la funcion devuelve false, se deja de recorrer.");
+	hospital_destruir(hospital);
+}
+
+bool guardar_saludes(pokemon_t *pokemon, void *saludes)
+{
+	size_t *vector = saludes;
+	vector[vector[0]++ + 1] = pokemon_salud(pokemon);
+	return vector[0] < 3;
+}
+
+void pruebas_hospital_rangos_de_salud()
+{
+	hospital_t *hospital =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_contar_en_rango(NULL, 0, 10) == 0 &&
+			     hospital_contar_en_rango(hospital, 10, 0) == 0,
+		     "No se cuenta con un hospital NULL o un rango invertido.");
+	pa2m_afirmar(hospital_contar_en_rango(hospital, 0, 9) == 1 &&
+			     hospital_contar_en_rango(hospital, 19, 32) == 5 &&
+			     hospital_contar_en_rango(hospital, 100,
+						      SIZE_MAX) == 0 &&
+			     hospital_contar_en_rango(hospital, 0, SIZE_MAX) ==
+				     12,
+		     "Se cuentan los pokemon con salud en un rango.");
+	size_t saludes[4] = { 0 };
+	pa2m_afirmar(hospital_a_cada_pokemon_en_rango(hospital, 19, 32,
+						      guardar_saludes,
+						      saludes) == 3 &&
+			     saludes[1] == 19 && saludes[2] == 20 &&
+			     saludes[3] == 20,
+		     "Se recorren en orden de prioridad los pokemon del rango.");
+
+	pokemon_t *ambulancia[] = { pokemon_crear_desde_string(
+		"20,Ditto,25,Ana") };
+	hospital_aceptar_emergencias(hospital, ambulancia, 1);
+	pa2m_afirmar(hospital_contar_en_rango(hospital, 19, 32) == 6,
+		     "Los rangos incluyen a los pokemon de emergencias.");
+	hospital_destruir(hospital);
+
+	hospital = hospital_abrir_mmap("ejemplos/grande.txt");
+	size_t contador = 0;
+	pa2m_afirmar(hospital_contar_en_rango(hospital, 19, 32) == 5 &&
+			     hospital_a_cada_pokemon_en_rango(
+				     hospital, 0, 20, contar_pokemon,
+				     &contador) == 4,
+		     "Se consultan rangos en la vista de un archivo mapeado.");
+	hospital_destruir(hospital);
+}
+
+void pruebas_hospital_fusion()
+{
+	hospital_t *destino =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_t *origen =
+		hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_t *vista = hospital_abrir_mmap("ejemplos/grande.txt");
+	pa2m_afirmar(hospital_fusionar(NULL, origen) == ERROR &&
+			     hospital_fusionar(destino, NULL) == ERROR &&
+			     hospital_fusionar(destino, destino) == ERROR &&
+			     hospital_fusionar(destino, vista) == ERROR &&
+			     hospital_fusionar(vista, origen) == ERROR,
+		     "No se fusiona con parametros invalidos ni con una vista.");
+	hospital_destruir(vista);
+
+	pokemon_t *ambulancia[] = {
+		pokemon_crear_desde_string("30,Mewtwo,1,Ana"),
+		pokemon_crear_desde_string("31,Ditto,20,Ana")
+	};
+	hospital_aceptar_emergencias(origen, ambulancia, 2);
+	pokemon_t *primero_destino = hospital_obtener_pokemon(destino, 2);
+	pokemon_t *primero_origen = hospital_obtener_pokemon(origen, 3);
+	hospital_buscar_por_id(destino, 1);
+	instantanea_t *instantanea = hospital_instantanea(destino);
+	pa2m_afirmar(hospital_fusionar(destino, origen) == EXITO &&
+			     hospital_cantidad_pokemones(destino) == 26 &&
+			     saludes_en_orden(destino),
+		     "Se fusionan los pokemon de ambos hospitales en orden de "
+		     "salud.");
+	pa2m_afirmar(hospital_obtener_pokemon(destino, 5) == primero_destino &&
+			     hospital_obtener_pokemon(destino, 7) ==
+				     primero_origen &&
+			     hospital_obtener_pokemon(destino, 9) ==
+				     ambulancia[1],
+		     "A igual salud, los pokemon del origen quedan detras de "
+		     "los del destino y conservan su orden.");
+	size_t prioridad = 0;
+	pa2m_afirmar(hospital_buscar_por_id(destino, 30) == ambulancia[0] &&
+			     hospital_prioridad_pokemon(destino, 31,
+							&prioridad) == EXITO &&
+			     prioridad == 9,
+		     "Los indices del destino incluyen a los pokemon del "
+		     "origen.");
+	double promedio = 0;
+	pa2m_afirmar(hospital_cantidad_entrenadores(destino) == 4 &&
+			     estadisticas_son(destino, "Lucas", 8, 19, 22.75) &&
+			     estadisticas_son(destino, "Ana", 2, 1, 10.5) &&
+			     hospital_salud_promedio(destino, &promedio) ==
+				     EXITO &&
+			     promedio > 45.65 && promedio < 45.66,
+		     "Se fusionan las estadisticas de ambos hospitales.");
+	pa2m_afirmar(instantanea_cantidad(instantanea) == 12,
+		     "Una instantanea anterior a la fusion no cambia.");
+	instantanea_liberar(instantanea);
+
+	pokemon_t *atendido = hospital_atender_siguiente(destino);
+	pa2m_afirmar(atendido && pokemon_id(atendido) == 30 &&
+			     hospital_cantidad_pokemones(destino) == 25 &&
+			     saludes_en_orden(destino),
+		     "Se sigue atendiendo en orden despues de la fusion.");
+	pokemon_destruir(atendido);
+	hospital_destruir(destino);
+
+	const char *ruta = "prueba_fusion.bin";
+	remove(ruta);
+	destino = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	origen = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_abrir_diario(destino, ruta, SINCRONIZAR_CADA_LOTE, 0);
+	hospital_fusionar(destino, origen);
+	hospital_actualizar_salud(destino, 1, 3);
+	hospital_t *recuperado =
+		hospital_recuperar("ejemplos/grande.txt", ruta);
+	pa2m_afirmar(mismos_pokemon(destino, recuperado),
+		     "Se recupera del diario un hospital fusionado.");
+	hospital_destruir(recuperado);
+	hospital_destruir(destino);
+	remove(ruta);
+
+	destino = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	origen = hospital_crear_desde_archivo("ejemplos/grande.txt");
+	hospital_habilitar_concurrencia(destino);
+	hospital_habilitar_concurrencia(origen);
+	pa2m_afirmar(hospital_fusionar(destino, origen) == EXITO &&
+			     hospital_cantidad_pokemones(destino) == 24,
+		     "Se fusionan dos hospitales concurrentes.");
+	hospital_destruir(destino);
+}
+
 int main()
 {
 	pa2m_nuevo_grupo(
@@ -435,5 +2145,113 @@ int main()
 	pruebas_ayuda_unica_opcion();
 	pruebas_ayuda_varias_opciones();
 
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE TDA: HEAP -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HEAP: CREACIÓN");
+	pruebas_heap_casos_borde();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HEAP: INSERTAR Y EXTRAER");
+	pruebas_heap_insertar_y_extraer();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HEAP: CREACIÓN DESDE VECTOR");
+	pruebas_heap_desde_vector();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HEAP: POSICIONES");
+	pruebas_heap_posiciones();
+
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE TDA: ABB -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE ABB: CREACIÓN");
+	pruebas_abb_casos_borde();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE ABB: POSICIONES");
+	pruebas_abb_posiciones();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE ABB: RECORRIDO EN ORDEN");
+	pruebas_abb_desde_ordenados_y_recorrido();
+
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE TDA: ARENA -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE ARENA: CREACIÓN");
+	pruebas_arena_casos_borde();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE ARENA: RESERVAR Y LIBERAR");
+	pruebas_arena_reservar_y_liberar();
+
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE TDA: LECTOR -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE LECTOR: CREACIÓN");
+	pruebas_lector_casos_borde();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE LECTOR: LECTURA DE LINEAS");
+	pruebas_lector_lineas();
+
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE POKEMON -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE POKEMON: LECTURA DESDE STRING");
+	pruebas_pokemon_lectura_desde_string();
+
+	pa2m_nuevo_grupo(
+		"\nXx------------------- PRUEBAS DE HOSPITAL -------------------xX");
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: EMERGENCIAS Y PRIORIDADES");
+	pruebas_hospital_emergencias_intercaladas();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: PRIORIDAD POR ID");
+	pruebas_hospital_prioridad_por_id();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: INDICES SECUNDARIOS");
+	pruebas_hospital_indices_secundarios();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: ESTADISTICAS POR ENTRENADOR");
+	pruebas_hospital_estadisticas_entrenador();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: RANGOS DE SALUD");
+	pruebas_hospital_rangos_de_salud();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: DISTRIBUCION DE SALUD");
+	pruebas_hospital_distribucion_de_salud();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: PEORES K");
+	pruebas_hospital_peores_k();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: ATENCION Y CAMBIOS DE SALUD");
+	pruebas_hospital_atender_y_actualizar();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: FUSION DE HOSPITALES");
+	pruebas_hospital_fusion();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: COLA DE EMERGENCIAS");
+	pruebas_hospital_cola_emergencias();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: CONCURRENCIA");
+	pruebas_hospital_concurrente();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: INSTANTANEAS");
+	pruebas_hospital_instantaneas();
+	pruebas_hospital_instantaneas_grandes();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: RECORRIDO PARALELO");
+	pruebas_hospital_recorrido_paralelo();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: CARGA DE ARCHIVOS");
+	pruebas_hospital_carga_grande();
+	pruebas_hospital_carga_saludes_amplias();
+	pruebas_hospital_carga_paralela();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: ARCHIVOS BINARIOS");
+	pruebas_hospital_archivo_binario();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: VISTA MAPEADA EN MEMORIA");
+	pruebas_hospital_vista_mapeada();
+
+	pa2m_nuevo_grupo("\nPRUEBAS DE HOSPITAL: DIARIO DE EMERGENCIAS");
+	pruebas_hospital_diario();
+
 	return pa2m_mostrar_reporte();
 }
\ No newline at end of file
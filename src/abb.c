@@ -0,0 +1,546 @@
+#include <stdlib.h>
+
+#include "abb.h"
+#include "arena.h"
+
+#define CAPACIDAD_INICIAL_NODOS 64
+
+/**
+ * Estructura de cada nodo del arbol. Ademas del elemento y sus hijos, guarda
+ * la altura del subarbol (para mantener el balanceo AVL) y la cantidad de
+ * elementos del subarbol (para las consultas por posicion).
+*/
+typedef struct nodo_abb {
+	void *elemento;
+	struct nodo_abb *izquierdo;
+	struct nodo_abb *derecho;
+	size_t tamanio;
+	int altura;
+} nodo_abb_t;
+
+/**
+ * Estructura principal del arbol, con la raiz, la cantidad total de
+ * elementos y el comparador que define el orden. Los nodos se reservan de
+ * una arena propia del arbol, asi destruirlo no libera nodo por nodo.
+*/
+struct abb {
+	nodo_abb_t *raiz;
+	size_t tamanio;
+	int (*comparador)(void *, void *);
+	arena_t *nodos;
+};
+
+/**
+ * Resultado de las operaciones recursivas de insercion.
+*/
+typedef enum { INSERTADO, REPETIDO, SIN_MEMORIA } resultado_insercion_t;
+
+/**
+ * Crea un arbol vacio cuya arena de nodos ya tiene lugar para la cantidad de
+ * elementos indicada.
+ *
+ * Devuelve un puntero al arbol creado o NULL en caso de error.
+*/
+abb_t *abb_crear_con_capacidad(int (*comparador)(void *, void *),
+			       size_t capacidad)
+{
+	if (!comparador)
+		return NULL;
+	abb_t *arbol_creado = calloc(1, sizeof(abb_t));
+	if (!arbol_creado)
+		return NULL;
+	arbol_creado->nodos = arena_crear(sizeof(nodo_abb_t), capacidad);
+	if (!arbol_creado->nodos) {
+		free(arbol_creado);
+		return NULL;
+	}
+	arbol_creado->comparador = comparador;
+	return arbol_creado;
+}
+
+/*
+ * Crea un arbol AVL vacio reservando la memoria necesaria.
+ *
+ * Devuelve un puntero al arbol creado o NULL en caso de error.
+ */
+abb_t *abb_crear(int (*comparador)(void *, void *))
+{
+	return abb_crear_con_capacidad(comparador, CAPACIDAD_INICIAL_NODOS);
+}
+
+/**
+ * Reserva de la arena del arbol un nodo hoja con el elemento recibido.
+*/
+nodo_abb_t *nodo_abb_crear(abb_t *arbol, void *elemento)
+{
+	nodo_abb_t *nodo_creado = arena_reservar(arbol->nodos);
+	if (!nodo_creado)
+		return NULL;
+	nodo_creado->elemento = elemento;
+	nodo_creado->tamanio = 1;
+	nodo_creado->altura = 1;
+	return nodo_creado;
+}
+
+/**
+ * Devuelve la altura del subarbol (0 si es vacio).
+*/
+int altura_subarbol(nodo_abb_t *nodo)
+{
+	return (!nodo) ? 0 : nodo->altura;
+}
+
+/**
+ * Devuelve la cantidad de elementos del subarbol (0 si es vacio).
+*/
+size_t tamanio_subarbol(nodo_abb_t *nodo)
+{
+	return (!nodo) ? 0 : nodo->tamanio;
+}
+
+/**
+ * Recalcula la altura y el tamaño del nodo a partir de los de sus hijos.
+*/
+void actualizar_nodo(nodo_abb_t *nodo)
+{
+	int altura_izquierda = altura_subarbol(nodo->izquierdo);
+	int altura_derecha = altura_subarbol(nodo->derecho);
+	nodo->altura = 1 + (altura_izquierda > altura_derecha ?
+				    altura_izquierda :
+				    altura_derecha);
+	nodo->tamanio = 1 + tamanio_subarbol(nodo->izquierdo) +
+			tamanio_subarbol(nodo->derecho);
+}
+
+/**
+ * Rota el subarbol hacia la derecha y devuelve la nueva raiz del subarbol.
+*/
+nodo_abb_t *rotar_derecha(nodo_abb_t *nodo)
+{
+	nodo_abb_t *nueva_raiz = nodo->izquierdo;
+	nodo->izquierdo = nueva_raiz->derecho;
+	nueva_raiz->derecho = nodo;
+	actualizar_nodo(nodo);
+	actualizar_nodo(nueva_raiz);
+	return nueva_raiz;
+}
+
+/**
+ * Rota el subarbol hacia la izquierda y devuelve la nueva raiz del subarbol.
+*/
+nodo_abb_t *rotar_izquierda(nodo_abb_t *nodo)
+{
+	nodo_abb_t *nueva_raiz = nodo->derecho;
+	nodo->derecho = nueva_raiz->izquierdo;
+	nueva_raiz->izquierdo = nodo;
+	actualizar_nodo(nodo);
+	actualizar_nodo(nueva_raiz);
+	return nueva_raiz;
+}
+
+/**
+ * Actualiza el nodo y, si quedo desbalanceado, aplica las rotaciones
+ * necesarias. Devuelve la nueva raiz del subarbol.
+*/
+nodo_abb_t *balancear(nodo_abb_t *nodo)
+{
+	actualizar_nodo(nodo);
+	int balance =
+		altura_subarbol(nodo->izquierdo) - altura_subarbol(nodo->derecho);
+	if (balance > 1) {
+		if (altura_subarbol(nodo->izquierdo->izquierdo) <
+		    altura_subarbol(nodo->izquierdo->derecho))
+			nodo->izquierdo = rotar_izquierda(nodo->izquierdo);
+		return rotar_derecha(nodo);
+	}
+	if (balance < -1) {
+		if (altura_subarbol(nodo->derecho->derecho) <
+		    altura_subarbol(nodo->derecho->izquierdo))
+			nodo->derecho = rotar_derecha(nodo->derecho);
+		return rotar_izquierda(nodo);
+	}
+	return nodo;
+}
+
+/**
+ * Construye recursivamente un subarbol balanceado con los elementos del
+ * vector ordenado en el rango [inicio, fin).
+ *
+ * Devuelve la raiz del subarbol. Si no hay memoria, se marca *error y se
+ * devuelve lo construido hasta el momento para poder liberarlo.
+*/
+nodo_abb_t *construir_subarbol(abb_t *arbol, void **vector, size_t inicio,
+			       size_t fin, bool *error)
+{
+	if (inicio >= fin || *error)
+		return NULL;
+	size_t medio = inicio + (fin - inicio) / 2;
+	nodo_abb_t *nodo = nodo_abb_crear(arbol, vector[medio]);
+	if (!nodo) {
+		*error = true;
+		return NULL;
+	}
+	nodo->izquierdo =
+		construir_subarbol(arbol, vector, inicio, medio, error);
+	nodo->derecho = construir_subarbol(arbol, vector, medio + 1, fin, error);
+	actualizar_nodo(nodo);
+	return nodo;
+}
+
+/*
+ * Crea un arbol balanceado con los elementos del vector ordenado en tiempo
+ * lineal.
+ *
+ * Devuelve un puntero al arbol creado o NULL en caso de error.
+ */
+abb_t *abb_crear_desde_ordenados(int (*comparador)(void *, void *),
+				 void **vector, size_t cantidad)
+{
+	if (!vector && cantidad > 0)
+		return NULL;
+	abb_t *arbol_creado = abb_crear_con_capacidad(comparador, cantidad);
+	if (!arbol_creado)
+		return NULL;
+	bool error = false;
+	arbol_creado->raiz =
+		construir_subarbol(arbol_creado, vector, 0, cantidad, &error);
+	if (error) {
+		abb_destruir(arbol_creado);
+		return NULL;
+	}
+	arbol_creado->tamanio = cantidad;
+	return arbol_creado;
+}
+
+/**
+ * Funcion utilizada por abb_insertar() que inserta el elemento en el
+ * subarbol, rebalanceando en el camino de vuelta. Devuelve la nueva raiz del
+ * subarbol y deja en *resultado si se pudo insertar.
+*/
+nodo_abb_t *insertar_en_subarbol(abb_t *arbol, nodo_abb_t *nodo,
+				 void *elemento,
+				 resultado_insercion_t *resultado)
+{
+	if (!nodo) {
+		nodo_abb_t *nodo_creado = nodo_abb_crear(arbol, elemento);
+		*resultado = (nodo_creado) ? INSERTADO : SIN_MEMORIA;
+		return nodo_creado;
+	}
+	int comparacion = arbol->comparador(elemento, nodo->elemento);
+	if (comparacion == 0) {
+		*resultado = REPETIDO;
+		return nodo;
+	}
+	if (comparacion < 0)
+		nodo->izquierdo = insertar_en_subarbol(arbol, nodo->izquierdo,
+						       elemento, resultado);
+	else
+		nodo->derecho = insertar_en_subarbol(arbol, nodo->derecho,
+						     elemento, resultado);
+	if (*resultado != INSERTADO)
+		return nodo;
+	return balancear(nodo);
+}
+
+/*
+ * Inserta un elemento en el arbol en O(log n).
+ *
+ * Devuelve el arbol o NULL en caso de error o si el elemento ya existia.
+ */
+abb_t *abb_insertar(abb_t *arbol, void *elemento)
+{
+	if (!arbol)
+		return NULL;
+	resultado_insercion_t resultado = INSERTADO;
+	arbol->raiz =
+		insertar_en_subarbol(arbol, arbol->raiz, elemento, &resultado);
+	if (resultado != INSERTADO)
+		return NULL;
+	arbol->tamanio++;
+	return arbol;
+}
+
+/**
+ * Quita el menor nodo del subarbol y lo deja en *minimo. Devuelve la nueva
+ * raiz del subarbol.
+*/
+nodo_abb_t *quitar_minimo(nodo_abb_t *nodo, nodo_abb_t **minimo)
+{
+	if (!nodo->izquierdo) {
+		*minimo = nodo;
+		return nodo->derecho;
+	}
+	nodo->izquierdo = quitar_minimo(nodo->izquierdo, minimo);
+	return balancear(nodo);
+}
+
+/**
+ * Funcion utilizada por abb_quitar() que quita el elemento del subarbol y lo
+ * deja en *quitado. Devuelve la nueva raiz del subarbol.
+*/
+nodo_abb_t *quitar_de_subarbol(abb_t *arbol, nodo_abb_t *nodo, void *elemento,
+			       void **quitado)
+{
+	if (!nodo)
+		return NULL;
+	int comparacion = arbol->comparador(elemento, nodo->elemento);
+	if (comparacion < 0) {
+		nodo->izquierdo = quitar_de_subarbol(arbol, nodo->izquierdo,
+						     elemento, quitado);
+	} else if (comparacion > 0) {
+		nodo->derecho = quitar_de_subarbol(arbol, nodo->derecho,
+						   elemento, quitado);
+	} else {
+		*quitado = nodo->elemento;
+		nodo_abb_t *reemplazo = NULL;
+		if (!nodo->izquierdo || !nodo->derecho) {
+			reemplazo = (nodo->izquierdo) ? nodo->izquierdo :
+							nodo->derecho;
+		} else {
+			nodo_abb_t *derecho =
+				quitar_minimo(nodo->derecho, &reemplazo);
+			reemplazo->derecho = derecho;
+			reemplazo->izquierdo = nodo->izquierdo;
+		}
+		arena_liberar(arbol->nodos, nodo);
+		return (reemplazo) ? balancear(reemplazo) : NULL;
+	}
+	return balancear(nodo);
+}
+
+/*
+ * Quita del arbol el elemento igual al recibido y lo devuelve.
+ *
+ * Devuelve NULL si no encuentra el elemento o en caso de error.
+ */
+void *abb_quitar(abb_t *arbol, void *elemento)
+{
+	if (abb_vacio(arbol))
+		return NULL;
+	void *quitado = NULL;
+	arbol->raiz = quitar_de_subarbol(arbol, arbol->raiz, elemento, &quitado);
+	if (quitado)
+		arbol->tamanio--;
+	return quitado;
+}
+
+/*
+ * Devuelve el elemento del arbol igual al recibido, o NULL si no existe.
+ */
+void *abb_buscar(abb_t *arbol, void *elemento)
+{
+	if (!arbol)
+		return NULL;
+	nodo_abb_t *actual = arbol->raiz;
+	while (actual) {
+		int comparacion = arbol->comparador(elemento, actual->elemento);
+		if (comparacion == 0)
+			return actual->elemento;
+		actual = (comparacion < 0) ? actual->izquierdo : actual->derecho;
+	}
+	return NULL;
+}
+
+/*
+ * Devuelve el elemento en la posicion indicada del recorrido inorden en
+ * O(log n), descendiendo segun el tamaño de cada subarbol izquierdo.
+ *
+ * Si no existe dicha posicion devuelve NULL.
+ */
+void *abb_elemento_en_posicion(abb_t *arbol, size_t posicion)
+{
+	if (posicion >= abb_tamanio(arbol))
+		return NULL;
+	nodo_abb_t *actual = arbol->raiz;
+	while (actual) {
+		size_t izquierda = tamanio_subarbol(actual->izquierdo);
+		if (posicion == izquierda)
+			return actual->elemento;
+		if (posicion < izquierda) {
+			actual = actual->izquierdo;
+		} else {
+			posicion -= izquierda + 1;
+			actual = actual->derecho;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Busca el elemento y guarda su posicion inorden en *posicion en O(log n).
+ *
+ * Devuelve true si encontro el elemento o false en caso contrario.
+ */
+bool abb_posicion(abb_t *arbol, void *elemento, size_t *posicion)
+{
+	if (!arbol || !posicion)
+		return false;
+	size_t anteriores = 0;
+	nodo_abb_t *actual = arbol->raiz;
+	while (actual) {
+		int comparacion = arbol->comparador(elemento, actual->elemento);
+		if (comparacion < 0) {
+			actual = actual->izquierdo;
+			continue;
+		}
+		size_t izquierda = tamanio_subarbol(actual->izquierdo);
+		if (comparacion == 0) {
+			*posicion = anteriores + izquierda;
+			return true;
+		}
+		anteriores += izquierda + 1;
+		actual = actual->derecho;
+	}
+	return false;
+}
+
+/*
+ * Devuelve la cantidad de elementos del arbol menores (segun el comparador)
+ * al recibido en O(log n), que es la posicion inorden que ocuparia.
+ */
+size_t abb_cantidad_menores(abb_t *arbol, void *elemento)
+{
+	if (!arbol)
+		return 0;
+	size_t menores = 0;
+	nodo_abb_t *actual = arbol->raiz;
+	while (actual) {
+		if (arbol->comparador(actual->elemento, elemento) < 0) {
+			menores += tamanio_subarbol(actual->izquierdo) + 1;
+			actual = actual->derecho;
+		} else {
+			actual = actual->izquierdo;
+		}
+	}
+	return menores;
+}
+
+/*
+ * Devuelve la cantidad de elementos almacenados en el arbol o 0 si no existe.
+ */
+size_t abb_tamanio(abb_t *arbol)
+{
+	return (!arbol) ? 0 : arbol->tamanio;
+}
+
+/*
+ * Devuelve true si el arbol esta vacio (o no existe) o false en caso
+ * contrario.
+ */
+bool abb_vacio(abb_t *arbol)
+{
+	return abb_tamanio(arbol) == 0;
+}
+
+/**
+ * Funcion utilizada por abb_con_cada_elemento() que recorre el subarbol
+ * inorden. Devuelve false si la funcion del usuario pidio cortar la
+ * iteracion.
+*/
+bool recorrer_inorden(nodo_abb_t *nodo, bool (*funcion)(void *, void *),
+		      void *contexto, size_t *invocaciones)
+{
+	if (!nodo)
+		return true;
+	if (!recorrer_inorden(nodo->izquierdo, funcion, contexto, invocaciones))
+		return false;
+	(*invocaciones)++;
+	if (!funcion(nodo->elemento, contexto))
+		return false;
+	return recorrer_inorden(nodo->derecho, funcion, contexto, invocaciones);
+}
+
+/*
+ * Recorre el arbol inorden invocando la funcion con cada elemento y el
+ * contexto. Si la funcion devuelve false se deja de iterar.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion o 0 en caso de error.
+ */
+size_t abb_con_cada_elemento(abb_t *arbol, bool (*funcion)(void *, void *),
+			     void *contexto)
+{
+	size_t invocaciones = 0;
+	if (!arbol || !funcion)
+		return invocaciones;
+	recorrer_inorden(arbol->raiz, funcion, contexto, &invocaciones);
+	return invocaciones;
+}
+
+/**
+ * Funcion utilizada por abb_con_cada_elemento_en_rango() que recorre inorden
+ * solo los elementos del subarbol con posicion en [desde, hasta), siendo
+ * primera la posicion del menor elemento del subarbol. Los subarboles que
+ * quedan fuera del rango no se visitan. Devuelve false si la funcion del
+ * usuario pidio cortar la iteracion.
+*/
+bool recorrer_rango(nodo_abb_t *nodo, size_t primera, size_t desde,
+		    size_t hasta, bool (*funcion)(void *, void *),
+		    void *contexto, size_t *invocaciones)
+{
+	if (!nodo || hasta <= primera || desde >= primera + nodo->tamanio)
+		return true;
+	size_t posicion = primera + tamanio_subarbol(nodo->izquierdo);
+	if (!recorrer_rango(nodo->izquierdo, primera, desde, hasta, funcion,
+			    contexto, invocaciones))
+		return false;
+	if (posicion >= desde && posicion < hasta) {
+		(*invocaciones)++;
+		if (!funcion(nodo->elemento, contexto))
+			return false;
+	}
+	return recorrer_rango(nodo->derecho, posicion + 1, desde, hasta,
+			      funcion, contexto, invocaciones);
+}
+
+/*
+ * Recorre inorden los elementos con posicion en [desde, hasta) en
+ * O(log n + hasta - desde).
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion o 0 en caso de error.
+ */
+size_t abb_con_cada_elemento_en_rango(abb_t *arbol, size_t desde, size_t hasta,
+				      bool (*funcion)(void *, void *),
+				      void *contexto)
+{
+	size_t invocaciones = 0;
+	if (!arbol || !funcion)
+		return invocaciones;
+	recorrer_rango(arbol->raiz, 0, desde, hasta, funcion, contexto,
+		       &invocaciones);
+	return invocaciones;
+}
+
+/**
+ * Aplica recursivamente el destructor a cada elemento del subarbol. Los nodos
+ * no se liberan aca: se liberan todos juntos al destruir la arena.
+*/
+void destruir_subarbol(nodo_abb_t *nodo, void (*destructor)(void *))
+{
+	if (!nodo)
+		return;
+	destruir_subarbol(nodo->izquierdo, destructor);
+	destruir_subarbol(nodo->derecho, destructor);
+	destructor(nodo->elemento);
+}
+
+/*
+ * Libera la memoria reservada por el arbol.
+ */
+void abb_destruir(abb_t *arbol)
+{
+	abb_destruir_todo(arbol, NULL);
+}
+
+/*
+ * Libera la memoria reservada por el arbol aplicando la funcion destructora
+ * (si no es NULL) a cada uno de los elementos presentes en el arbol.
+ */
+void abb_destruir_todo(abb_t *arbol, void (*destructor)(void *))
+{
+	if (!arbol)
+		return;
+	if (destructor)
+		destruir_subarbol(arbol->raiz, destructor);
+	arena_destruir(arbol->nodos);
+	free(arbol);
+}
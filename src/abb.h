@@ -0,0 +1,123 @@
+#ifndef __ABB_H__
+#define __ABB_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct abb abb_t;
+
+/**
+ * Crea un arbol binario de busqueda autobalanceado (AVL) reservando la
+ * memoria necesaria.
+ *
+ * El comparador recibe dos elementos y devuelve un numero menor a 0 si el
+ * primero va antes que el segundo, 0 si son iguales o un numero mayor a 0 si
+ * el primero va despues que el segundo. El arbol no admite elementos iguales
+ * segun el comparador.
+ *
+ * Cada nodo guarda la cantidad de elementos de su subarbol, lo que permite
+ * obtener el elemento en una posicion y la posicion de un elemento en
+ * O(log n).
+ *
+ * Devuelve un puntero al arbol creado o NULL en caso de error.
+ */
+abb_t *abb_crear(int (*comparador)(void *, void *));
+
+/**
+ * Crea un arbol balanceado con los elementos del vector recibido, que deben
+ * estar ordenados segun el comparador y no repetirse. La construccion es
+ * lineal en la cantidad de elementos.
+ *
+ * Devuelve un puntero al arbol creado o NULL en caso de error.
+ */
+abb_t *abb_crear_desde_ordenados(int (*comparador)(void *, void *),
+				 void **vector, size_t cantidad);
+
+/**
+ * Inserta un elemento en el arbol en O(log n).
+ *
+ * Devuelve el arbol o NULL en caso de error o si el elemento ya existia.
+ */
+abb_t *abb_insertar(abb_t *arbol, void *elemento);
+
+/**
+ * Quita del arbol el elemento igual (segun el comparador) al recibido y lo
+ * devuelve.
+ *
+ * Devuelve NULL si no encuentra el elemento o en caso de error.
+ */
+void *abb_quitar(abb_t *arbol, void *elemento);
+
+/**
+ * Devuelve el elemento del arbol igual (segun el comparador) al recibido, o
+ * NULL si no existe.
+ */
+void *abb_buscar(abb_t *arbol, void *elemento);
+
+/**
+ * Devuelve el elemento que se encuentra en la posicion indicada del recorrido
+ * inorden, donde 0 es el menor elemento del arbol.
+ *
+ * Si no existe dicha posicion devuelve NULL.
+ */
+void *abb_elemento_en_posicion(abb_t *arbol, size_t posicion);
+
+/**
+ * Busca el elemento igual (segun el comparador) al recibido y guarda en
+ * *posicion su posicion en el recorrido inorden.
+ *
+ * Devuelve true si encontro el elemento o false en caso contrario.
+ */
+bool abb_posicion(abb_t *arbol, void *elemento, size_t *posicion);
+
+/**
+ * Devuelve la cantidad de elementos del arbol menores (segun el comparador)
+ * al recibido, que no necesita estar en el arbol. Es la posicion inorden del
+ * primer elemento mayor o igual al recibido.
+ */
+size_t abb_cantidad_menores(abb_t *arbol, void *elemento);
+
+/**
+ * Devuelve la cantidad de elementos almacenados en el arbol o 0 si no existe.
+ */
+size_t abb_tamanio(abb_t *arbol);
+
+/**
+ * Devuelve true si el arbol esta vacio (o no existe) o false en caso
+ * contrario.
+ */
+bool abb_vacio(abb_t *arbol);
+
+/**
+ * Iterador interno. Recorre el arbol inorden invocando la funcion con cada
+ * elemento y el contexto. Si la funcion devuelve false se deja de iterar.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion o 0 en caso de error.
+ */
+size_t abb_con_cada_elemento(abb_t *arbol, bool (*funcion)(void *, void *),
+			     void *contexto);
+
+/**
+ * Iterador interno por posiciones. Recorre inorden solo los elementos con
+ * posicion en [desde, hasta), en O(log n) mas la cantidad de elementos
+ * recorridos. Si la funcion devuelve false se deja de iterar.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion o 0 en caso de error.
+ */
+size_t abb_con_cada_elemento_en_rango(abb_t *arbol, size_t desde, size_t hasta,
+				      bool (*funcion)(void *, void *),
+				      void *contexto);
+
+/**
+ * Libera la memoria reservada por el arbol.
+ */
+void abb_destruir(abb_t *arbol);
+
+/**
+ * Libera la memoria reservada por el arbol pero además aplica la función
+ * destructora dada (si no es NULL) a cada uno de los elementos presentes en el
+ * arbol.
+ */
+void abb_destruir_todo(abb_t *arbol, void (*destructor)(void *));
+
+#endif /* __ABB_H__ */
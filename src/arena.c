@@ -0,0 +1,234 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define CAPACIDAD_MINIMA_ARENA 64
+
+/**
+ * Bloque contiguo de registros. Los registros se entregan en orden y el
+ * bloque guarda cuantos se entregaron hasta el momento.
+*/
+typedef struct bloque {
+	struct bloque *siguiente;
+	size_t capacidad;
+	size_t usados;
+	char *registros;
+} bloque_t;
+
+/**
+ * Registro devuelto a la arena. Mientras esta libre, el propio registro se
+ * usa para enlazar la lista de registros disponibles.
+*/
+typedef struct registro_libre {
+	struct registro_libre *siguiente;
+} registro_libre_t;
+
+/**
+ * Estructura principal de la arena. Los bloques se enlazan del mas nuevo (en
+ * el que se siguen reservando registros) al mas viejo.
+*/
+struct arena {
+	bloque_t *bloques;
+	registro_libre_t *libres;
+	size_t tamanio_registro;
+	size_t cantidad;
+};
+
+/**
+ * Crea un bloque con lugar para la cantidad de registros indicada.
+ *
+ * Devuelve un puntero al bloque creado o NULL en caso de error.
+*/
+bloque_t *bloque_crear(size_t capacidad, size_t tamanio_registro)
+{
+	bloque_t *bloque = calloc(1, sizeof(bloque_t));
+	if (!bloque)
+		return NULL;
+	bloque->registros = malloc(capacidad * tamanio_registro);
+	if (!bloque->registros) {
+		free(bloque);
+		return NULL;
+	}
+	bloque->capacidad = capacidad;
+	return bloque;
+}
+
+/*
+ * Crea una arena de registros de tamaño fijo.
+ *
+ * Devuelve un puntero a la arena creada o NULL en caso de error.
+ */
+arena_t *arena_crear(size_t tamanio_registro, size_t capacidad_inicial)
+{
+	if (tamanio_registro == 0)
+		return NULL;
+	arena_t *arena_creada = calloc(1, sizeof(arena_t));
+	if (!arena_creada)
+		return NULL;
+	size_t alineacion = sizeof(void *);
+	if (tamanio_registro < sizeof(registro_libre_t))
+		tamanio_registro = sizeof(registro_libre_t);
+	arena_creada->tamanio_registro =
+		(tamanio_registro + alineacion - 1) / alineacion * alineacion;
+
+	if (capacidad_inicial < CAPACIDAD_MINIMA_ARENA)
+		capacidad_inicial = CAPACIDAD_MINIMA_ARENA;
+	arena_creada->bloques =
+		bloque_crear(capacidad_inicial, arena_creada->tamanio_registro);
+	if (!arena_creada->bloques) {
+		free(arena_creada);
+		return NULL;
+	}
+	return arena_creada;
+}
+
+/*
+ * Reserva un registro de la arena, inicializado en cero.
+ *
+ * Devuelve un puntero al registro o NULL en caso de error.
+ */
+void *arena_reservar(arena_t *arena)
+{
+	if (!arena)
+		return NULL;
+	void *registro = NULL;
+	if (arena->libres) {
+		registro = arena->libres;
+		arena->libres = arena->libres->siguiente;
+	} else {
+		bloque_t *bloque = arena->bloques;
+		if (bloque->usados == bloque->capacidad) {
+			bloque = bloque_crear(bloque->capacidad * 2,
+					      arena->tamanio_registro);
+			if (!bloque)
+				return NULL;
+			bloque->siguiente = arena->bloques;
+			arena->bloques = bloque;
+		}
+		registro = bloque->registros +
+			   bloque->usados * arena->tamanio_registro;
+		bloque->usados++;
+	}
+	memset(registro, 0, arena->tamanio_registro);
+	arena->cantidad++;
+	return registro;
+}
+
+/*
+ * Reserva la cantidad indicada de registros consecutivos de la arena, sin
+ * inicializarlos. Si no entran en el bloque actual se agrega un bloque nuevo
+ * con lugar para todos ellos.
+ *
+ * Devuelve un puntero al primer registro o NULL en caso de error.
+ */
+void *arena_reservar_varios(arena_t *arena, size_t cantidad)
+{
+	if (!arena || cantidad == 0 ||
+	    cantidad > SIZE_MAX / 2 / arena->tamanio_registro)
+		return NULL;
+	bloque_t *bloque = arena->bloques;
+	if (bloque->capacidad - bloque->usados < cantidad) {
+		size_t capacidad = bloque->capacidad * 2;
+		bloque = bloque_crear((capacidad < cantidad) ? cantidad :
+							       capacidad,
+				      arena->tamanio_registro);
+		if (!bloque)
+			return NULL;
+		bloque->siguiente = arena->bloques;
+		arena->bloques = bloque;
+	}
+	void *registros =
+		bloque->registros + bloque->usados * arena->tamanio_registro;
+	bloque->usados += cantidad;
+	arena->cantidad += cantidad;
+	return registros;
+}
+
+/*
+ * Devuelve un registro a la arena para que pueda ser reutilizado.
+ */
+void arena_liberar(arena_t *arena, void *registro)
+{
+	if (!arena || !registro)
+		return;
+	registro_libre_t *libre = registro;
+	libre->siguiente = arena->libres;
+	arena->libres = libre;
+	arena->cantidad--;
+}
+
+/*
+ * Devuelve true si el puntero pertenece a alguno de los bloques de la arena.
+ * Como cada bloque duplica al anterior, hay O(log n) bloques para revisar.
+ */
+bool arena_contiene(arena_t *arena, void *registro)
+{
+	if (!arena || !registro)
+		return false;
+	uintptr_t direccion = (uintptr_t)registro;
+	for (bloque_t *bloque = arena->bloques; bloque;
+	     bloque = bloque->siguiente) {
+		uintptr_t inicio = (uintptr_t)bloque->registros;
+		uintptr_t fin = inicio + bloque->usados * arena->tamanio_registro;
+		if (direccion >= inicio && direccion < fin)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Devuelve la cantidad de registros reservados (y no liberados) de la arena.
+ */
+size_t arena_cantidad(arena_t *arena)
+{
+	return (!arena) ? 0 : arena->cantidad;
+}
+
+/*
+ * Pasa todos los bloques de la arena origen a la arena destino y destruye la
+ * arena origen. Los bloques de origen se enlazan detras del bloque actual de
+ * destino, que sigue siendo el bloque donde se reservan nuevos registros.
+ *
+ * Devuelve false en caso de error.
+ */
+bool arena_absorber(arena_t *destino, arena_t *origen)
+{
+	if (!destino || !origen || destino == origen ||
+	    destino->tamanio_registro != origen->tamanio_registro)
+		return false;
+	bloque_t *ultimo_bloque = origen->bloques;
+	while (ultimo_bloque->siguiente)
+		ultimo_bloque = ultimo_bloque->siguiente;
+	ultimo_bloque->siguiente = destino->bloques->siguiente;
+	destino->bloques->siguiente = origen->bloques;
+
+	if (origen->libres) {
+		registro_libre_t *ultimo_libre = origen->libres;
+		while (ultimo_libre->siguiente)
+			ultimo_libre = ultimo_libre->siguiente;
+		ultimo_libre->siguiente = destino->libres;
+		destino->libres = origen->libres;
+	}
+	destino->cantidad += origen->cantidad;
+	free(origen);
+	return true;
+}
+
+/*
+ * Libera todos los bloques de la arena, y con ellos todos sus registros.
+ */
+void arena_destruir(arena_t *arena)
+{
+	if (!arena)
+		return;
+	bloque_t *bloque = arena->bloques;
+	while (bloque) {
+		bloque_t *siguiente = bloque->siguiente;
+		free(bloque->registros);
+		free(bloque);
+		bloque = siguiente;
+	}
+	free(arena);
+}
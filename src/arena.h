@@ -0,0 +1,68 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct arena arena_t;
+
+/**
+ * Crea una arena de registros de tamaño fijo. Los registros se reservan de a
+ * bloques contiguos grandes (el primero con lugar para la capacidad inicial
+ * indicada, y cada bloque siguiente del doble que el anterior), por lo que
+ * reservar millones de registros solo necesita unas pocas llamadas a malloc y
+ * destruir la arena unas pocas llamadas a free.
+ *
+ * Devuelve un puntero a la arena creada o NULL en caso de error.
+ */
+arena_t *arena_crear(size_t tamanio_registro, size_t capacidad_inicial);
+
+/**
+ * Reserva un registro de la arena, inicializado en cero. Si hay registros
+ * devueltos con arena_liberar(), se reutilizan antes de tomar uno nuevo.
+ *
+ * Devuelve un puntero al registro o NULL en caso de error.
+ */
+void *arena_reservar(arena_t *arena);
+
+/**
+ * Reserva la cantidad indicada de registros consecutivos de la arena, por
+ * ejemplo para llenarlos con una sola lectura de un archivo. A diferencia de
+ * arena_reservar(), los registros no se inicializan.
+ *
+ * Devuelve un puntero al primer registro o NULL en caso de error.
+ */
+void *arena_reservar_varios(arena_t *arena, size_t cantidad);
+
+/**
+ * Devuelve un registro a la arena para que pueda ser reutilizado. La memoria
+ * no se libera hasta que se destruye la arena.
+ */
+void arena_liberar(arena_t *arena, void *registro);
+
+/**
+ * Devuelve true si el puntero pertenece a alguno de los bloques de la arena
+ * o false en caso contrario.
+ */
+bool arena_contiene(arena_t *arena, void *registro);
+
+/**
+ * Devuelve la cantidad de registros reservados (y no liberados) de la arena.
+ */
+size_t arena_cantidad(arena_t *arena);
+
+/**
+ * Pasa todos los bloques de la arena origen (con sus registros, que conservan
+ * su direccion) a la arena destino y destruye la arena origen. Ambas arenas
+ * deben ser de registros del mismo tamaño.
+ *
+ * Devuelve false en caso de error, sin modificar ninguna de las arenas.
+ */
+bool arena_absorber(arena_t *destino, arena_t *origen);
+
+/**
+ * Libera todos los bloques de la arena, y con ellos todos sus registros.
+ */
+void arena_destruir(arena_t *arena);
+
+#endif /* __ARENA_H__ */
@@ -0,0 +1,271 @@
+#include <stdlib.h>
+
+#include "heap.h"
+
+#define CAPACIDAD_MINIMA_HEAP 8
+
+/**
+ * Estructura principal del heap. Los elementos se almacenan en un vector
+ * dinamico que representa un arbol binario completo: los hijos del elemento
+ * en la posicion i se encuentran en las posiciones 2i + 1 y 2i + 2.
+*/
+struct heap {
+	void **vector;
+	size_t cantidad;
+	size_t capacidad;
+	int (*comparador)(void *, void *);
+	void (*actualizar_posicion)(void *elemento, size_t posicion);
+};
+
+/*
+ * Crea un heap minimal reservando la memoria necesaria para el.
+ *
+ * Devuelve un puntero al heap creado o NULL en caso de error.
+ */
+heap_t *heap_crear(int (*comparador)(void *, void *), size_t capacidad)
+{
+	if (!comparador)
+		return NULL;
+	heap_t *heap_creado = calloc(1, sizeof(heap_t));
+	if (!heap_creado)
+		return NULL;
+	if (capacidad < CAPACIDAD_MINIMA_HEAP)
+		capacidad = CAPACIDAD_MINIMA_HEAP;
+	heap_creado->vector = malloc(sizeof(void *) * capacidad);
+	if (!heap_creado->vector) {
+		free(heap_creado);
+		return NULL;
+	}
+	heap_creado->capacidad = capacidad;
+	heap_creado->comparador = comparador;
+	return heap_creado;
+}
+
+/**
+ * Guarda el elemento en la posicion recibida del vector, avisando su nueva
+ * posicion si el heap sigue las posiciones de sus elementos.
+*/
+void ubicar_elemento(heap_t *heap, void *elemento, size_t posicion)
+{
+	heap->vector[posicion] = elemento;
+	if (heap->actualizar_posicion)
+		heap->actualizar_posicion(elemento, posicion);
+}
+
+/**
+ * Intercambia los elementos del heap en las posiciones recibidas.
+*/
+void intercambiar_elementos(heap_t *heap, size_t i, size_t j)
+{
+	void *aux = heap->vector[i];
+	ubicar_elemento(heap, heap->vector[j], i);
+	ubicar_elemento(heap, aux, j);
+}
+
+/**
+ * Sube el elemento de la posicion recibida mientras tenga mas prioridad que
+ * su padre, restaurando la propiedad de heap.
+*/
+void subir_elemento(heap_t *heap, size_t posicion)
+{
+	while (posicion > 0) {
+		size_t padre = (posicion - 1) / 2;
+		if (heap->comparador(heap->vector[posicion],
+				     heap->vector[padre]) >= 0)
+			return;
+		intercambiar_elementos(heap, posicion, padre);
+		posicion = padre;
+	}
+}
+
+/**
+ * Baja el elemento de la posicion recibida mientras alguno de sus hijos
+ * tenga mas prioridad que el, restaurando la propiedad de heap.
+*/
+void bajar_elemento(heap_t *heap, size_t posicion)
+{
+	while (true) {
+		size_t menor = posicion;
+		size_t izquierdo = 2 * posicion + 1;
+		size_t derecho = 2 * posicion + 2;
+		if (izquierdo < heap->cantidad &&
+		    heap->comparador(heap->vector[izquierdo],
+				     heap->vector[menor]) < 0)
+			menor = izquierdo;
+		if (derecho < heap->cantidad &&
+		    heap->comparador(heap->vector[derecho],
+				     heap->vector[menor]) < 0)
+			menor = derecho;
+		if (menor == posicion)
+			return;
+		intercambiar_elementos(heap, posicion, menor);
+		posicion = menor;
+	}
+}
+
+/*
+ * Crea un heap con los elementos del vector recibido reorganizandolos en
+ * tiempo lineal (heapify de abajo hacia arriba).
+ *
+ * Devuelve un puntero al heap creado o NULL en caso de error.
+ */
+heap_t *heap_crear_desde_vector(int (*comparador)(void *, void *),
+				void **vector, size_t cantidad)
+{
+	if (!vector && cantidad > 0)
+		return NULL;
+	heap_t *heap_creado = heap_crear(comparador, cantidad);
+	if (!heap_creado)
+		return NULL;
+	for (size_t i = 0; i < cantidad; i++)
+		heap_creado->vector[i] = vector[i];
+	heap_creado->cantidad = cantidad;
+	for (size_t i = cantidad / 2; i > 0; i--)
+		bajar_elemento(heap_creado, i - 1);
+	return heap_creado;
+}
+
+/*
+ * Reemplaza el vector del heap por el recibido y lo reorganiza en tiempo
+ * lineal, avisando las posiciones de todos los elementos.
+ *
+ * Devuelve false en caso de error.
+ */
+bool heap_reemplazar_vector(heap_t *heap, void **vector, size_t cantidad,
+			    size_t capacidad)
+{
+	if (!heap || !vector || capacidad == 0 || cantidad > capacidad)
+		return false;
+	free(heap->vector);
+	heap->vector = vector;
+	heap->cantidad = cantidad;
+	heap->capacidad = capacidad;
+	for (size_t i = cantidad / 2; i > 0; i--)
+		bajar_elemento(heap, i - 1);
+	heap_seguir_posiciones(heap, heap->actualizar_posicion);
+	return true;
+}
+
+/*
+ * Inserta un elemento en el heap, duplicando la capacidad del vector si
+ * fuera necesario.
+ *
+ * Devuelve el heap o NULL en caso de error.
+ */
+heap_t *heap_insertar(heap_t *heap, void *elemento)
+{
+	if (!heap)
+		return NULL;
+	if (heap->cantidad == heap->capacidad) {
+		void **nuevo_vector =
+			realloc(heap->vector,
+				sizeof(void *) * heap->capacidad * 2);
+		if (!nuevo_vector)
+			return NULL;
+		heap->vector = nuevo_vector;
+		heap->capacidad *= 2;
+	}
+	ubicar_elemento(heap, elemento, heap->cantidad);
+	heap->cantidad++;
+	subir_elemento(heap, heap->cantidad - 1);
+	return heap;
+}
+
+/*
+ * Devuelve el elemento de mayor prioridad sin quitarlo, o NULL si el heap
+ * esta vacio o no existe.
+ */
+void *heap_raiz(heap_t *heap)
+{
+	if (heap_vacio(heap))
+		return NULL;
+	return heap->vector[0];
+}
+
+/*
+ * Quita del heap el elemento de mayor prioridad y lo devuelve.
+ *
+ * Devuelve NULL si el heap esta vacio o no existe.
+ */
+void *heap_extraer_raiz(heap_t *heap)
+{
+	return heap_quitar(heap, 0);
+}
+
+/*
+ * Hace que el heap avise la posicion de cada elemento cada vez que la
+ * cambia, empezando por las posiciones actuales de todos los elementos.
+ */
+void heap_seguir_posiciones(heap_t *heap,
+			    void (*actualizar_posicion)(void *elemento,
+							size_t posicion))
+{
+	if (!heap)
+		return;
+	heap->actualizar_posicion = actualizar_posicion;
+	if (actualizar_posicion)
+		for (size_t i = 0; i < heap->cantidad; i++)
+			actualizar_posicion(heap->vector[i], i);
+}
+
+/*
+ * Restaura la propiedad de heap despues de que cambio la prioridad del
+ * elemento en la posicion indicada, subiendolo o bajandolo segun haga falta.
+ *
+ * Devuelve false si la posicion no existe.
+ */
+bool heap_reubicar(heap_t *heap, size_t posicion)
+{
+	if (posicion >= heap_tamanio(heap))
+		return false;
+	subir_elemento(heap, posicion);
+	bajar_elemento(heap, posicion);
+	return true;
+}
+
+/*
+ * Quita del heap el elemento en la posicion indicada y lo devuelve. El ultimo
+ * elemento ocupa su lugar y se reubica.
+ *
+ * Devuelve NULL si la posicion no existe.
+ */
+void *heap_quitar(heap_t *heap, size_t posicion)
+{
+	if (posicion >= heap_tamanio(heap))
+		return NULL;
+	void *quitado = heap->vector[posicion];
+	heap->cantidad--;
+	if (posicion < heap->cantidad) {
+		ubicar_elemento(heap, heap->vector[heap->cantidad], posicion);
+		heap_reubicar(heap, posicion);
+	}
+	return quitado;
+}
+
+/*
+ * Devuelve la cantidad de elementos almacenados en el heap o 0 si no existe.
+ */
+size_t heap_tamanio(heap_t *heap)
+{
+	return (!heap) ? 0 : heap->cantidad;
+}
+
+/*
+ * Devuelve true si el heap esta vacio (o no existe) o false en caso
+ * contrario.
+ */
+bool heap_vacio(heap_t *heap)
+{
+	return heap_tamanio(heap) == 0;
+}
+
+/*
+ * Libera la memoria reservada por el heap.
+ */
+void heap_destruir(heap_t *heap)
+{
+	if (!heap)
+		return;
+	free(heap->vector);
+	free(heap);
+}
@@ -0,0 +1,110 @@
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct heap heap_t;
+
+/**
+ * Crea un heap minimal reservando la memoria necesaria para el.
+ *
+ * El comparador recibe dos elementos y devuelve un numero menor a 0 si el
+ * primero tiene mas prioridad que el segundo (debe quedar mas cerca de la
+ * raiz), 0 si son equivalentes o un numero mayor a 0 en caso contrario.
+ *
+ * Capacidad indica la cantidad de elementos para la que se reserva memoria
+ * inicialmente. El heap crece automaticamente si se supera.
+ *
+ * Devuelve un puntero al heap creado o NULL en caso de error.
+ */
+heap_t *heap_crear(int (*comparador)(void *, void *), size_t capacidad);
+
+/**
+ * Crea un heap con los elementos del vector recibido (se copian los punteros,
+ * no los elementos) reorganizandolos en tiempo lineal.
+ *
+ * Devuelve un puntero al heap creado o NULL en caso de error.
+ */
+heap_t *heap_crear_desde_vector(int (*comparador)(void *, void *),
+				void **vector, size_t cantidad);
+
+/**
+ * Reemplaza los elementos del heap por los del vector recibido, del que el
+ * heap pasa a ser dueño (no se copia), reorganizandolos en tiempo lineal. La
+ * capacidad es la cantidad de elementos para los que se reservo el vector, y
+ * debe ser mayor a 0. Si el heap sigue las posiciones de sus elementos, se
+ * avisan las de todos.
+ *
+ * Devuelve false en caso de error, sin modificar el heap ni tomar el vector.
+ */
+bool heap_reemplazar_vector(heap_t *heap, void **vector, size_t cantidad,
+			    size_t capacidad);
+
+/**
+ * Inserta un elemento en el heap.
+ *
+ * Devuelve el heap o NULL en caso de error.
+ */
+heap_t *heap_insertar(heap_t *heap, void *elemento);
+
+/**
+ * Devuelve el elemento de mayor prioridad (la raiz del heap) sin quitarlo, o
+ * NULL si el heap esta vacio o no existe.
+ */
+void *heap_raiz(heap_t *heap);
+
+/**
+ * Quita del heap el elemento de mayor prioridad y lo devuelve.
+ *
+ * Devuelve NULL si el heap esta vacio o no existe.
+ */
+void *heap_extraer_raiz(heap_t *heap);
+
+/**
+ * Hace que el heap avise la posicion que ocupa cada elemento, invocando la
+ * funcion con el elemento y su posicion cada vez que la cambia. Al llamarla
+ * se avisan las posiciones actuales de todos los elementos. Con NULL se deja
+ * de avisar.
+ *
+ * Guardar la posicion recibida en el propio elemento permite luego quitarlo o
+ * reubicarlo con heap_quitar() y heap_reubicar() en O(log n).
+ */
+void heap_seguir_posiciones(heap_t *heap,
+			    void (*actualizar_posicion)(void *elemento,
+							size_t posicion));
+
+/**
+ * Restaura la propiedad de heap despues de que cambio la prioridad del
+ * elemento en la posicion indicada, subiendolo o bajandolo segun haga falta,
+ * en O(log n).
+ *
+ * Devuelve false si la posicion no existe.
+ */
+bool heap_reubicar(heap_t *heap, size_t posicion);
+
+/**
+ * Quita del heap el elemento en la posicion indicada y lo devuelve, en
+ * O(log n).
+ *
+ * Devuelve NULL si la posicion no existe.
+ */
+void *heap_quitar(heap_t *heap, size_t posicion);
+
+/**
+ * Devuelve la cantidad de elementos almacenados en el heap o 0 si no existe.
+ */
+size_t heap_tamanio(heap_t *heap);
+
+/**
+ * Devuelve true si el heap esta vacio (o no existe) o false en caso
+ * contrario.
+ */
+bool heap_vacio(heap_t *heap);
+
+/**
+ * Libera la memoria reservada por el heap.
+ */
+void heap_destruir(heap_t *heap);
+
+#endif /* __HEAP_H__ */
@@ -0,0 +1,540 @@
+#ifndef HOSPITAL_H_
+#define HOSPITAL_H_
+
+#include "tp1.h"
+
+#define SINCRONIZAR_CADA_LOTE 0
+#define SINCRONIZAR_PERIODICAMENTE 1
+#define SINCRONIZAR_NUNCA 2
+
+/**
+ * Operaciones del hospital que extienden las de tp1.h (que no se puede
+ * modificar). Todas reciben un hospital creado con las funciones de tp1.h.
+ */
+
+/**
+ * Busca el pokemon con el id indicado y guarda en *prioridad su prioridad
+ * actual (siendo 0 la mas alta, el pokemon con menos salud). Si hay varios
+ * pokemon con el mismo id, se considera el que ingreso primero al hospital.
+ *
+ * La primera consulta construye un indice por id que luego se mantiene al
+ * aceptar emergencias, por lo que las siguientes consultas cuestan O(log n).
+ *
+ * Devuelve -1 en caso de error o si no existe el pokemon, o 0 en caso de éxito.
+ */
+int hospital_prioridad_pokemon(hospital_t *hospital, size_t id,
+			       size_t *prioridad);
+
+/**
+ * Devuelve el pokemon con el id indicado (si hay varios, el que ingreso
+ * primero al hospital) o NULL si no existe o en caso de error.
+ *
+ * Igual que hospital_prioridad_pokemon(), la primera consulta construye un
+ * indice por id que luego se mantiene, por lo que las siguientes cuestan O(1).
+ */
+pokemon_t *hospital_buscar_por_id(hospital_t *hospital, size_t id);
+
+/**
+ * Devuelve el pokemon con el nombre indicado (si hay varios, el que ingreso
+ * primero al hospital) o NULL si no existe o en caso de error.
+ *
+ * La primera consulta construye un indice por nombre que luego se mantiene,
+ * por lo que las siguientes cuestan O(1).
+ */
+pokemon_t *hospital_buscar_por_nombre(hospital_t *hospital,
+				      const char *nombre);
+
+/**
+ * Aplica la funcion a cada uno de los pokemon del entrenador indicado, en el
+ * orden en que se indexaron (no necesariamente el de prioridad). Igual que
+ * en hospital_a_cada_pokemon(), si la funcion devuelve false no se continua.
+ *
+ * La primera llamada construye un indice por entrenador que luego se
+ * mantiene, por lo que las siguientes cuestan O(1) mas la cantidad de
+ * pokemon del entrenador.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_de_entrenador(
+	hospital_t *hospital, const char *entrenador,
+	bool (*funcion)(pokemon_t *p, void *aux), void *aux);
+
+/**
+ * Estadisticas de los pokemon de un entrenador internados en el hospital.
+ */
+typedef struct estadisticas_entrenador {
+	size_t cantidad;
+	size_t salud_minima;
+	double salud_promedio;
+} estadisticas_entrenador_t;
+
+/**
+ * Guarda en *estadisticas la cantidad de pokemon del entrenador indicado, su
+ * salud minima y su salud promedio.
+ *
+ * El hospital mantiene las estadisticas de cada entrenador a medida que
+ * ingresan, se atienden o cambian de salud sus pokemon, por lo que la
+ * consulta cuesta O(1) sin recorrer pokemon (salvo en un hospital abierto
+ * con hospital_abrir_mmap(), donde se recorren todos).
+ *
+ * Devuelve -1 en caso de error o si el entrenador no tiene pokemon en el
+ * hospital, o 0 en caso de éxito.
+ */
+int hospital_estadisticas_entrenador(hospital_t *hospital,
+				     const char *entrenador,
+				     estadisticas_entrenador_t *estadisticas);
+
+/**
+ * Devuelve la cantidad de entrenadores distintos con pokemon en el hospital,
+ * en O(1) (salvo en un hospital abierto con hospital_abrir_mmap(), donde se
+ * recorren todos los pokemon).
+ */
+size_t hospital_cantidad_entrenadores(hospital_t *hospital);
+
+/**
+ * Devuelve la cantidad de pokemon del hospital con salud entre minimo y
+ * maximo, inclusive, en O(log n). Devuelve 0 si minimo es mayor que maximo o
+ * en caso de error.
+ */
+size_t hospital_contar_en_rango(hospital_t *hospital, size_t minimo,
+				size_t maximo);
+
+/**
+ * Aplica la funcion a cada pokemon del hospital con salud entre minimo y
+ * maximo, inclusive, en orden de prioridad. Igual que en
+ * hospital_a_cada_pokemon(), si la funcion devuelve false no se continua.
+ *
+ * Cuesta O(log n) mas la cantidad de pokemon recorridos: los pokemon fuera
+ * del rango no se visitan.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_en_rango(hospital_t *hospital, size_t minimo,
+					size_t maximo,
+					bool (*funcion)(pokemon_t *p,
+							void *aux),
+					void *aux);
+
+/**
+ * Aplica la funcion a cada pokemon del hospital usando hasta la cantidad de
+ * hilos indicada (como maximo 64). El orden de prioridad se reparte en tramos
+ * consecutivos, uno por hilo, y cada hilo recorre el suyo en orden pasandole
+ * a la funcion su propio aux: aux_por_hilo debe tener hilos posiciones. Se
+ * usan menos hilos si el hospital es chico (hay al menos 8192 pokemon por
+ * hilo) y uno solo para un hospital abierto con hospital_abrir_mmap(); los
+ * aux que no se usan no se modifican.
+ *
+ * Como los tramos se recorren a la vez, la funcion solo puede modificar su
+ * aux (y no el hospital ni los pokemon). Si la funcion devuelve false, todos
+ * los hilos dejan de recorrer en cuanto lo notan.
+ *
+ * Si combinar no es NULL, al terminar se invoca combinar(aux_por_hilo[0],
+ * aux_por_hilo[i]) para cada i entre 1 y hilos - 1, en ese orden, para
+ * reunir en el primer aux los resultados de todos los hilos.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_paralelo(
+	hospital_t *hospital, bool (*funcion)(pokemon_t *p, void *aux),
+	void **aux_por_hilo, size_t hilos,
+	void (*combinar)(void *aux, void *aux_hilo));
+
+/**
+ * Guarda en *salud el percentil indicado (entre 0 y 100) de las saludes del
+ * hospital, segun el metodo del rango mas cercano: la menor salud tal que al
+ * menos el percentil por ciento de los pokemon tiene esa salud o menos. Por
+ * ejemplo, con 50 se obtiene la mediana, con 0 la salud minima y con 100 la
+ * maxima.
+ *
+ * Cuesta O(log n): el arbol de prioridades ya tiene las saludes ordenadas.
+ *
+ * Devuelve -1 en caso de error o si el hospital esta vacio, o 0 en caso de
+ * éxito.
+ */
+int hospital_percentil_salud(hospital_t *hospital, double percentil,
+			     size_t *salud);
+
+/**
+ * Devuelve la cantidad de pokemon del hospital con salud menor a la
+ * indicada, en O(log n), o 0 en caso de error.
+ */
+size_t hospital_contar_salud_menor_a(hospital_t *hospital, size_t salud);
+
+/**
+ * Guardan en *salud la salud minima (en O(1)) o maxima (en O(log n)) del
+ * hospital.
+ *
+ * Devuelven -1 en caso de error o si el hospital esta vacio, o 0 en caso de
+ * éxito.
+ */
+int hospital_salud_minima(hospital_t *hospital, size_t *salud);
+int hospital_salud_maxima(hospital_t *hospital, size_t *salud);
+
+/**
+ * Guarda en *promedio la salud promedio del hospital, en O(1) (salvo en un
+ * hospital abierto con hospital_abrir_mmap(), donde se recorren todos los
+ * pokemon).
+ *
+ * Devuelve -1 en caso de error o si el hospital esta vacio, o 0 en caso de
+ * éxito.
+ */
+int hospital_salud_promedio(hospital_t *hospital, double *promedio);
+
+/**
+ * Guarda en el vector peores (con lugar para al menos k punteros) los k
+ * pokemon de mayor prioridad (los de menos salud), en orden de prioridad, sin
+ * modificar el hospital. Si el hospital tiene menos de k pokemon, se guardan
+ * todos.
+ *
+ * Cuesta O(log n + k): no se recorre ni se ordena el resto del hospital.
+ *
+ * Devuelve la cantidad de pokemon guardados, o 0 en caso de error.
+ */
+size_t hospital_peores_k(hospital_t *hospital, size_t k, pokemon_t **peores);
+
+/**
+ * Atiende al pokemon de mayor prioridad (el de menos salud) y lo quita del
+ * hospital, en O(log n).
+ *
+ * El pokemon devuelto pasa a ser responsabilidad del usuario, que debe
+ * liberarlo con pokemon_destruir(). Los punteros a ese pokemon obtenidos
+ * antes del hospital dejan de ser validos.
+ *
+ * Devuelve NULL si el hospital esta vacio o en caso de error.
+ */
+pokemon_t *hospital_atender_siguiente(hospital_t *hospital);
+
+/**
+ * Cambia la salud del pokemon con el id indicado (si hay varios, el que
+ * ingreso primero al hospital) y actualiza su prioridad, en O(log n) sin
+ * reordenar el resto del hospital. A igual salud, el pokemon conserva su
+ * orden de ingreso original.
+ *
+ * Igual que hospital_prioridad_pokemon(), la primera llamada construye el
+ * indice por id.
+ *
+ * Devuelve -1 en caso de error o si no existe el pokemon, o 0 en caso de éxito.
+ */
+int hospital_actualizar_salud(hospital_t *hospital, size_t id,
+			      size_t nueva_salud);
+
+/**
+ * Pasa todos los pokemon del hospital origen al destino, sin copiarlos, y
+ * destruye el origen: desde entonces el destino es responsable de liberarlos.
+ * Los ordenes de prioridad de ambos hospitales se mezclan en O(n + m), con un
+ * unico vector para todos los pokemon (que pasa a ser el del heap) y sin
+ * reservar memoria por pokemon.
+ *
+ * Los pokemon del origen se consideran ingresados despues de todos los del
+ * destino (a igual salud van detras de ellos) y conservan entre si su orden.
+ * Si el destino tiene un diario, la fusion se registra como un lote de
+ * emergencias con los pokemon del origen; el diario del origen se cierra.
+ *
+ * Los indices del destino se vuelven a construir en la proxima consulta que
+ * los use. Las instantaneas de ambos hospitales siguen siendo validas.
+ *
+ * Si los hospitales son concurrentes, se toman los cerrojos de ambos en un
+ * orden fijo (el de sus direcciones), por lo que dos fusiones entre los
+ * mismos hospitales no se bloquean mutuamente. Ningun otro hilo debe estar
+ * usando el origen, ya que se destruye.
+ *
+ * Devuelve -1 en caso de error (por ejemplo, si alguno fue abierto con
+ * hospital_abrir_mmap() o si son el mismo hospital), y ambos hospitales
+ * quedan como estaban, o 0 en caso de éxito.
+ */
+int hospital_fusionar(hospital_t *destino, hospital_t *origen);
+
+/**
+ * Establece la cantidad de hilos que usa hospital_crear_desde_archivo() para
+ * cargar archivos grandes (que se dividen en tramos, en limites de linea, que
+ * se procesan en paralelo) y para ordenar muchos pokemon. Con 0, el valor por
+ * defecto, se usa un hilo por procesador disponible. Los volumenes chicos se
+ * procesan siempre con un solo hilo.
+ *
+ * La configuracion es global y no debe cambiarse mientras se carga un
+ * hospital.
+ */
+void hospital_establecer_hilos(size_t hilos);
+
+/**
+ * Establece la cantidad minima de pokemon a partir de la cual se ordenan en
+ * paralelo (por defecto 65536). El ordenamiento en paralelo es estable, igual
+ * que el secuencial: a igual salud se respeta el orden del archivo.
+ */
+void hospital_establecer_umbral_paralelo(size_t cantidad);
+
+/**
+ * Guarda el hospital en un archivo binario que luego puede cargarse con
+ * hospital_cargar_binario() sin volver a interpretar el CSV.
+ *
+ * El archivo tiene un encabezado versionado (con la cantidad de pokemon y una
+ * suma de verificacion) seguido de un registro de tamaño fijo por pokemon,
+ * ya ordenados por prioridad. El formato depende de la arquitectura: solo se
+ * garantiza que pueda cargarlo un programa compilado para la misma.
+ *
+ * El archivo se escribe primero en un temporal con nombre unico en el mismo
+ * directorio, se sincroniza con el disco y recien entonces reemplaza al
+ * archivo indicado, sincronizando tambien el directorio: si el guardado
+ * falla, el archivo anterior (si existia) queda intacto, y varios guardados
+ * simultaneos al mismo archivo no se mezclan.
+ *
+ * Devuelve -1 en caso de error o si el hospital esta vacio (un archivo sin
+ * pokemon no puede cargarse), o 0 en caso de éxito.
+ */
+int hospital_guardar_binario(hospital_t *hospital, const char *nombre_archivo);
+
+/**
+ * Crea un hospital a partir de un archivo guardado con
+ * hospital_guardar_binario(). Los registros se leen con una sola lectura y,
+ * si el archivo indica que ya estan ordenados por prioridad, no se vuelven a
+ * ordenar. Los pokemon conservan su orden de ingreso.
+ *
+ * Devuelve NULL si el archivo no es un hospital binario valido (firma,
+ * version, tamaño o suma de verificacion incorrectos), si no contiene al
+ * menos un pokemon o en caso de error.
+ */
+hospital_t *hospital_cargar_binario(const char *nombre_archivo);
+
+/**
+ * Empieza a registrar en el archivo indicado (un diario) cada lote de
+ * emergencias que acepte el hospital, una vez que ingresa completo (si no
+ * puede registrarse, el lote no ingresa). Tambien se registra, como un lote de un solo pokemon, cada pokemon atendido con
+ * hospital_atender_siguiente() y cada cambio de salud de
+ * hospital_actualizar_salud(). Si el archivo no existe se crea; si existe, los
+ * nuevos lotes se agregan al final.
+ *
+ * Cada lote se agrega con una sola escritura, y la sincronizacion con el
+ * disco depende de la politica indicada:
+ *
+ * - SINCRONIZAR_CADA_LOTE: antes de confirmar cada lote (el mas seguro).
+ * - SINCRONIZAR_PERIODICAMENTE: un hilo sincroniza los lotes escritos a lo
+ *   sumo intervalo_ms milisegundos despues de la sincronizacion anterior,
+ *   aunque no lleguen nuevos lotes. Si una sincronizacion falla, el diario
+ *   deja de aceptar lotes (los siguientes no ingresan).
+ * - SINCRONIZAR_NUNCA: lo decide el sistema operativo. Un lote escrito no se
+ *   pierde si el programa se interrumpe, pero si el sistema se cae.
+ *
+ * Al destruir el hospital el diario se sincroniza (salvo con
+ * SINCRONIZAR_NUNCA) y se cierra.
+ *
+ * Para recuperar el hospital se usa hospital_recuperar() con el mismo archivo
+ * base con el que se creo el hospital. Al guardar un nuevo archivo base (por
+ * ejemplo con hospital_guardar_binario()), el diario anterior debe
+ * eliminarse.
+ *
+ * Devuelve -1 en caso de error (por ejemplo, si el archivo existe y no es un
+ * diario o si el hospital ya tiene un diario) o 0 en caso de éxito.
+ */
+int hospital_abrir_diario(hospital_t *hospital, const char *nombre_archivo,
+			  int sincronizacion, size_t intervalo_ms);
+
+/**
+ * Crea un hospital a partir de un archivo base (binario o CSV) y le vuelve a
+ * aplicar, en orden, las emergencias, atenciones y cambios de salud
+ * registrados en el diario indicado. Si el diario no existe, solo se carga el
+ * archivo base.
+ *
+ * La lectura del diario se detiene en el primer lote incompleto o corrupto
+ * (como el que se estaba escribiendo si el programa se interrumpio), y el
+ * diario se trunca en ese punto para poder seguir agregandole lotes con
+ * hospital_abrir_diario().
+ *
+ * Devuelve NULL en caso de error.
+ */
+hospital_t *hospital_recuperar(const char *archivo_base,
+			       const char *nombre_diario);
+
+/**
+ * Abre un archivo de hospital (CSV o guardado con hospital_guardar_binario())
+ * mapeandolo en memoria, para consultar archivos muy grandes sin copiar sus
+ * registros. De un CSV solo se arma un indice compacto con la posicion de
+ * cada pokemon en orden de prioridad (8 bytes por pokemon; al abrirlo se usan
+ * temporalmente hasta 24 para ordenarlo); el resto de la memoria que se usa
+ * es la cache de paginas del sistema operativo.
+ *
+ * Los pokemon de un archivo binario son directamente los registros del
+ * archivo, de solo lectura, y son validos hasta destruir el hospital. Los de
+ * un CSV se arman recien cuando se consultan:
+ *
+ * - Los que se piden de a uno (hospital_obtener_pokemon(),
+ *   hospital_peores_k(), las busquedas, etc.) se arman una sola vez y
+ *   siguen siendo validos hasta destruir el hospital; cada uno ocupa memoria
+ *   hasta entonces.
+ * - Los recorridos (hospital_a_cada_pokemon() y los demas) no guardan nada:
+ *   arman cada pokemon en un registro auxiliar que solo es valido durante la
+ *   llamada a la funcion, que no debe guardar el puntero.
+ *
+ * El hospital obtenido es de solo lectura: hospital_aceptar_emergencias(),
+ * hospital_atender_siguiente() y hospital_actualizar_salud() devuelven error,
+ * y las busquedas (hospital_prioridad_pokemon(),
+ * hospital_buscar_por_id(), etc.) recorren todo el indice en lugar de usar
+ * indices secundarios. De un archivo binario no se verifica la
+ * suma de verificacion, para no tener que leerlo completo al abrirlo.
+ *
+ * Devuelve NULL si el archivo no es valido, si no contiene al menos un
+ * pokemon o en caso de error.
+ */
+hospital_t *hospital_abrir_mmap(const char *nombre_archivo);
+
+/**
+ * Cola de ingreso de emergencias: varios hilos productores (por ejemplo, uno
+ * por cada fuente de ambulancias) encolan lotes de pokemon sin bloquearse
+ * entre si, y un unico hilo consumidor los ingresa al hospital juntando todos
+ * los lotes pendientes en un solo lote grande.
+ */
+typedef struct cola_emergencias cola_emergencias_t;
+
+/**
+ * Metricas de una cola de emergencias. Las latencias son el tiempo que pasa
+ * un lote desde que se encola hasta que ingresa al hospital.
+ */
+typedef struct metricas_cola {
+	size_t lotes_pendientes;
+	size_t pokemon_pendientes;
+	size_t lotes_ingresados;
+	size_t pokemon_ingresados;
+	size_t latencia_promedio_us;
+	size_t latencia_maxima_us;
+} metricas_cola_t;
+
+/**
+ * Crea una cola de emergencias vacia.
+ *
+ * Devuelve NULL en caso de error.
+ */
+cola_emergencias_t *cola_emergencias_crear(void);
+
+/**
+ * Encola un lote de pokemon. Puede llamarse desde varios hilos a la vez: el
+ * lote se copia y se agrega a la cola con una unica operacion atomica, sin
+ * esperar a otros productores ni al consumidor.
+ *
+ * Igual que con hospital_aceptar_emergencias(), desde que se encolan los
+ * pokemon pasan a ser responsabilidad de la cola (y luego del hospital). El
+ * vector recibido no se guarda.
+ *
+ * Devuelve -1 en caso de error (y los pokemon siguen siendo del usuario) o 0
+ * en caso de éxito.
+ */
+int cola_emergencias_encolar(cola_emergencias_t *cola, pokemon_t **pokemones,
+			     size_t cantidad);
+
+/**
+ * Ingresa al hospital, con una sola llamada a hospital_aceptar_emergencias(),
+ * todos los lotes encolados hasta el momento, en el orden en que se
+ * encolaron. Solo un hilo puede drenar la cola, y el hospital no debe usarse
+ * desde otros hilos mientras tanto, salvo que sea concurrente (ver
+ * hospital_habilitar_concurrencia()).
+ *
+ * Ingresan todos los pokemon encolados o ninguno: si el ingreso falla, los
+ * lotes se conservan en la cola y se vuelven a intentar ingresar, antes que
+ * los demas, la proxima vez.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int cola_emergencias_drenar(cola_emergencias_t *cola, hospital_t *hospital);
+
+/**
+ * Guarda en *metricas la profundidad actual de la cola (lotes y pokemon
+ * pendientes), lo ingresado hasta el momento y las latencias de ingreso.
+ * Puede llamarse desde cualquier hilo.
+ */
+void cola_emergencias_metricas(cola_emergencias_t *cola,
+			       metricas_cola_t *metricas);
+
+/**
+ * Destruye la cola, liberando los pokemon que no llegaron a ingresar. Ningun
+ * otro hilo debe estar usando la cola.
+ */
+void cola_emergencias_destruir(cola_emergencias_t *cola);
+
+/**
+ * Habilita el uso del hospital desde varios hilos a la vez. Desde entonces,
+ * cada operacion de este archivo y de tp1.h (salvo hospital_destruir()) toma
+ * un cerrojo de lectores y escritor:
+ *
+ * - Las consultas y recorridos (hospital_a_cada_pokemon(),
+ *   hospital_obtener_pokemon(), las busquedas, hospital_guardar_binario(),
+ *   etc.) no modifican el orden del hospital y comparten el cerrojo, por lo
+ *   que muchos hilos pueden recorrer el mismo hospital en paralelo.
+ * - hospital_aceptar_emergencias(), hospital_atender_siguiente(),
+ *   hospital_actualizar_salud(), hospital_fusionar(),
+ *   hospital_abrir_diario() y cola_emergencias_drenar() toman el cerrojo en
+ *   exclusiva.
+ *
+ * El cerrojo prefiere a los escritores: cuando uno espera, los nuevos
+ * lectores esperan detras de el, para que un flujo continuo de consultas no
+ * lo postergue indefinidamente. Por eso las funciones que se pasan a los
+ * recorridos no deben llamar a operaciones del mismo hospital (si un escritor
+ * llega en el medio, el recorrido no termina nunca).
+ *
+ * Un recorrido largo demora a los escritores hasta que termina. Para recorrer
+ * el hospital sin demorarlos, se puede recorrer una instantanea (ver
+ * hospital_instantanea()).
+ *
+ * Los pokemon obtenidos son validos hasta la siguiente operacion que
+ * modifique el hospital, y no deben modificarse.
+ *
+ * Un hospital abierto con hospital_abrir_mmap() no puede ser concurrente.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int hospital_habilitar_concurrencia(hospital_t *hospital);
+
+/**
+ * Instantanea de un hospital: una version inmutable de sus pokemon en orden
+ * de prioridad, que se puede recorrer sin tomar el cerrojo del hospital
+ * mientras otros hilos lo siguen modificando.
+ */
+typedef struct instantanea instantanea_t;
+
+/**
+ * Devuelve una instantanea del estado actual del hospital, que sigue siendo
+ * valida (e igual) aunque luego se acepten emergencias, se atiendan pokemon o
+ * se cambien saludes, y aunque se destruya el hospital. Debe liberarse con
+ * instantanea_liberar().
+ *
+ * Las instantaneas pedidas sin modificaciones del hospital en el medio
+ * comparten la misma version, que se copia (en O(n)) solo la primera vez. La
+ * memoria de cada version se libera cuando se suelta su ultima referencia.
+ *
+ * En un hospital concurrente la copia se hace de a bloques de pokemon,
+ * soltando el cerrojo entre uno y otro, por lo que los escritores esperan a
+ * lo sumo la copia de un bloque. Si el hospital se modifica en el medio, la
+ * copia vuelve a empezar; si se modifica durante varios intentos seguidos,
+ * el ultimo copia todo el hospital sin soltar el cerrojo.
+ *
+ * Devuelve NULL en caso de error.
+ */
+instantanea_t *hospital_instantanea(hospital_t *hospital);
+
+/**
+ * Devuelve la cantidad de pokemon de la instantanea.
+ */
+size_t instantanea_cantidad(instantanea_t *instantanea);
+
+/**
+ * Devuelve el pokemon de la instantanea con la prioridad indicada (siendo 0
+ * la mas alta) o NULL si no existe. El pokemon pertenece a la instantanea: no
+ * debe modificarse ni destruirse, y es valido hasta liberarla.
+ */
+pokemon_t *instantanea_obtener_pokemon(instantanea_t *instantanea,
+				       size_t prioridad);
+
+/**
+ * Aplica la funcion a cada pokemon de la instantanea en orden de prioridad,
+ * igual que hospital_a_cada_pokemon(). La funcion puede usar el hospital
+ * libremente, ya que el recorrido no toma su cerrojo.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t instantanea_a_cada_pokemon(instantanea_t *instantanea,
+				  bool (*funcion)(pokemon_t *p, void *aux),
+				  void *aux);
+
+/**
+ * Suelta la instantanea. Puede llamarse desde cualquier hilo.
+ */
+void instantanea_liberar(instantanea_t *instantanea);
+
+#endif // HOSPITAL_H_
@@ -0,0 +1,378 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define REGISTROS_POR_ESCRITURA 4096
+#define SUFIJO_TEMPORAL ".XXXXXX"
+#define PERMISOS_BINARIO 0644
+#define MULTIPLICADOR_SUMA 1099511628211ull
+
+/**
+ * Estado de la escritura del archivo binario: los registros se arman en un
+ * buffer y se escriben de a REGISTROS_POR_ESCRITURA.
+*/
+typedef struct escritura_binaria {
+	FILE *archivo;
+	pokemon_t *buffer;
+	size_t en_buffer;
+	uint64_t suma_verificacion;
+	bool exito;
+} escritura_binaria_t;
+
+/*
+ * Acumula en la suma los registros recibidos, de a palabras de 64 bits (el
+ * tamaño de pokemon_t es multiplo de 8 por la alineacion de sus size_t).
+ *
+ * Devuelve la suma actualizada.
+ */
+uint64_t sumar_registros(uint64_t suma, const pokemon_t *registros,
+			 size_t cantidad)
+{
+	const unsigned char *bytes = (const unsigned char *)registros;
+	size_t palabras = cantidad * sizeof(pokemon_t) / sizeof(uint64_t);
+	for (size_t i = 0; i < palabras; i++) {
+		uint64_t palabra;
+		memcpy(&palabra, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+		suma = (suma ^ palabra) * MULTIPLICADOR_SUMA;
+	}
+	return suma;
+}
+
+/*
+ * Copia el pokemon al registro binario campo a campo, sobre memoria en cero,
+ * para que el relleno no dependa de la memoria previa.
+ */
+void copiar_registro_binario(pokemon_t *registro, const pokemon_t *original)
+{
+	memset(registro, 0, sizeof(pokemon_t));
+	registro->id = original->id;
+	registro->salud = original->salud;
+	registro->ingreso = original->ingreso;
+	memcpy(registro->nombre, original->nombre,
+	       strnlen(original->nombre, MAX_NOMBRE - 1));
+	memcpy(registro->nombre_entrenador, original->nombre_entrenador,
+	       strnlen(original->nombre_entrenador, MAX_NOMBRE - 1));
+}
+
+/*
+ * Devuelve true si los nombres del registro binario estan terminados en
+ * '\0'.
+ */
+bool registro_binario_valido(const pokemon_t *registro)
+{
+	return memchr(registro->nombre, '\0', MAX_NOMBRE) &&
+	       memchr(registro->nombre_entrenador, '\0', MAX_NOMBRE);
+}
+
+/**
+ * Escribe los registros acumulados en el buffer y los suma a la verificacion.
+ *
+ * Devuelve false en caso de error.
+*/
+bool vaciar_escritura(escritura_binaria_t *escritura)
+{
+	if (escritura->en_buffer == 0)
+		return true;
+	escritura->suma_verificacion =
+		sumar_registros(escritura->suma_verificacion,
+				escritura->buffer, escritura->en_buffer);
+	size_t escritos = fwrite(escritura->buffer, sizeof(pokemon_t),
+				 escritura->en_buffer, escritura->archivo);
+	bool exito = escritos == escritura->en_buffer;
+	escritura->en_buffer = 0;
+	return exito;
+}
+
+/**
+ * Funcion utilizada por hospital_guardar_binario() que copia el pokemon
+ * recorrido al buffer de escritura.
+*/
+bool escribir_pokemon_binario(pokemon_t *original, void *escritura)
+{
+	escritura_binaria_t *datos = escritura;
+	copiar_registro_binario(&datos->buffer[datos->en_buffer++], original);
+	if (datos->en_buffer == REGISTROS_POR_ESCRITURA)
+		datos->exito = vaciar_escritura(datos);
+	return datos->exito;
+}
+
+/**
+ * Escribe el hospital en el archivo abierto (encabezado y registros) y lo
+ * sincroniza con el disco, sin cerrarlo.
+ *
+ * Devuelve false en caso de error.
+*/
+bool escribir_binario(hospital_t *hospital, FILE *archivo)
+{
+	escritura_binaria_t escritura = {
+		.archivo = archivo,
+		.suma_verificacion = SUMA_INICIAL,
+		.exito = true,
+	};
+	escritura.buffer = malloc(REGISTROS_POR_ESCRITURA * sizeof(pokemon_t));
+	if (!escritura.buffer)
+		return false;
+
+	size_t cantidad = cantidad_pokemones(hospital);
+	encabezado_binario_t encabezado = { 0 };
+	memcpy(encabezado.firma, FIRMA_BINARIO, sizeof(FIRMA_BINARIO));
+	encabezado.version = VERSION_BINARIO;
+	encabezado.banderas = BANDERA_ORDENADO;
+	encabezado.cantidad = cantidad;
+	encabezado.tamanio_registro = sizeof(pokemon_t);
+
+	// El encabezado se escribe dos veces: al principio reserva su lugar y
+	// al final se reescribe con la suma de verificacion de los registros.
+	bool exito = fwrite(&encabezado, sizeof(encabezado), 1,
+			    escritura.archivo) == 1;
+	if (exito)
+		exito = a_cada_pokemon(hospital, escribir_pokemon_binario,
+				       &escritura) == cantidad &&
+			escritura.exito && vaciar_escritura(&escritura);
+	if (exito) {
+		encabezado.suma_verificacion = escritura.suma_verificacion;
+		exito = fseek(escritura.archivo, 0, SEEK_SET) == 0 &&
+			fwrite(&encabezado, sizeof(encabezado), 1,
+			       escritura.archivo) == 1;
+	}
+	free(escritura.buffer);
+	return exito && fflush(archivo) == 0 && fsync(fileno(archivo)) == 0;
+}
+
+/**
+ * Sincroniza con el disco el directorio que contiene al archivo indicado,
+ * para que el reemplazo hecho con rename() no se pierda si el sistema se cae.
+ *
+ * Devuelve false en caso de error.
+*/
+bool sincronizar_directorio(const char *nombre_archivo)
+{
+	const char *barra = strrchr(nombre_archivo, '/');
+	size_t largo = (barra) ? (size_t)(barra - nombre_archivo) : 0;
+	char *directorio = malloc(largo + 2);
+	if (!directorio)
+		return false;
+	if (!barra) {
+		strcpy(directorio, ".");
+	} else if (largo == 0) {
+		strcpy(directorio, "/");
+	} else {
+		memcpy(directorio, nombre_archivo, largo);
+		directorio[largo] = '\0';
+	}
+	int descriptor = open(directorio, O_RDONLY);
+	free(directorio);
+	if (descriptor < 0)
+		return false;
+	bool exito = fsync(descriptor) == 0;
+	return close(descriptor) == 0 && exito;
+}
+
+/**
+ * Guarda el hospital en el archivo como hospital_guardar_binario(), sin tomar
+ * el cerrojo: lo escribe en un archivo temporal con nombre unico (creado con
+ * mkstemp(), para que dos guardados al mismo archivo no escriban en el mismo
+ * temporal) que luego reemplaza al indicado.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+*/
+int guardar_binario(hospital_t *hospital, const char *nombre_archivo)
+{
+	if (cantidad_pokemones(hospital) == 0)
+		return ERROR;
+	size_t largo = strlen(nombre_archivo);
+	char *temporal = malloc(largo + sizeof(SUFIJO_TEMPORAL));
+	if (!temporal)
+		return ERROR;
+	memcpy(temporal, nombre_archivo, largo);
+	memcpy(temporal + largo, SUFIJO_TEMPORAL, sizeof(SUFIJO_TEMPORAL));
+	int descriptor = mkstemp(temporal);
+	FILE *archivo = (descriptor >= 0) ? fdopen(descriptor, "wb") : NULL;
+	if (!archivo) {
+		if (descriptor >= 0) {
+			close(descriptor);
+			remove(temporal);
+		}
+		free(temporal);
+		return ERROR;
+	}
+	bool exito = fchmod(descriptor, PERMISOS_BINARIO) == 0 &&
+		     escribir_binario(hospital, archivo);
+	exito = fclose(archivo) == 0 && exito &&
+		rename(temporal, nombre_archivo) == 0;
+	if (!exito)
+		remove(temporal);
+	free(temporal);
+	return (exito && sincronizar_directorio(nombre_archivo)) ? EXITO :
+								   ERROR;
+}
+
+/*
+ * Guarda el hospital en un archivo binario, con los pokemon ordenados por
+ * prioridad.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int hospital_guardar_binario(hospital_t *hospital, const char *nombre_archivo)
+{
+	if (!hospital || !nombre_archivo)
+		return ERROR;
+	bloquear_lectura(hospital);
+	int resultado = guardar_binario(hospital, nombre_archivo);
+	desbloquear_lectura(hospital);
+	return resultado;
+}
+
+/*
+ * Valida el encabezado de un archivo binario del tamaño indicado (contando el
+ * encabezado).
+ *
+ * Devuelve false si el encabezado no es valido.
+ */
+bool validar_encabezado_binario(const encabezado_binario_t *encabezado,
+				uint64_t tamanio)
+{
+	return tamanio >= sizeof(*encabezado) &&
+	       memcmp(encabezado->firma, FIRMA_BINARIO,
+		      sizeof(FIRMA_BINARIO)) == 0 &&
+	       encabezado->version == VERSION_BINARIO &&
+	       (encabezado->banderas & ~BANDERA_ORDENADO) == 0 &&
+	       encabezado->tamanio_registro == sizeof(pokemon_t) &&
+	       encabezado->cantidad > 0 &&
+	       encabezado->cantidad <= SIZE_MAX / sizeof(pokemon_t) &&
+	       encabezado->cantidad ==
+		       (tamanio - sizeof(*encabezado)) / sizeof(pokemon_t) &&
+	       (tamanio - sizeof(*encabezado)) % sizeof(pokemon_t) == 0;
+}
+
+/**
+ * Lee y valida el encabezado del archivo binario. El tamaño del archivo debe
+ * coincidir exactamente con la cantidad de registros indicada, para no
+ * reservar memoria de mas por un encabezado corrupto.
+ *
+ * Devuelve false si el archivo no comienza con un encabezado valido.
+*/
+bool leer_encabezado_binario(FILE *archivo, encabezado_binario_t *encabezado)
+{
+	if (fread(encabezado, sizeof(*encabezado), 1, archivo) != 1 ||
+	    fseek(archivo, 0, SEEK_END) != 0)
+		return false;
+	long tamanio = ftell(archivo);
+	if (tamanio < 0 || fseek(archivo, sizeof(*encabezado), SEEK_SET) != 0)
+		return false;
+	return validar_encabezado_binario(encabezado, (uint64_t)tamanio);
+}
+
+/**
+ * Verifica que los nombres de los registros leidos esten terminados en '\0'
+ * y arma el vector de pokemones. Si los registros vienen ordenados, verifica
+ * ademas que respeten el orden de prioridad; si no, les asigna su orden de
+ * ingreso.
+ *
+ * Guarda en *ultimo_ingreso el ingreso mas alto de los registros.
+ *
+ * Devuelve false si algun registro es invalido.
+*/
+bool preparar_registros_binarios(pokemon_t *registros, size_t cantidad,
+				 bool ordenados, pokemon_t **pokemones,
+				 size_t *ultimo_ingreso)
+{
+	*ultimo_ingreso = 0;
+	for (size_t i = 0; i < cantidad; i++) {
+		pokemon_t *pokemon = &registros[i];
+		if (!registro_binario_valido(pokemon))
+			return false;
+		if (!ordenados)
+			pokemon->ingreso = i;
+		else if (i > 0 && comparar_prioridad_pokemones(pokemones[i - 1],
+								 pokemon) >= 0)
+			return false;
+		if (pokemon->ingreso > *ultimo_ingreso)
+			*ultimo_ingreso = pokemon->ingreso;
+		pokemones[i] = pokemon;
+	}
+	return true;
+}
+
+/**
+ * Lee los registros del archivo binario (ya posicionado despues del
+ * encabezado) en una arena nueva, con una sola lectura, y verifica que la
+ * suma de verificacion coincida.
+ *
+ * Devuelve la arena con los registros (y en *leidos el primero de ellos) o
+ * NULL en caso de error.
+*/
+arena_t *leer_registros_binarios(FILE *archivo,
+				 const encabezado_binario_t *encabezado,
+				 pokemon_t **leidos)
+{
+	size_t cantidad = (size_t)encabezado->cantidad;
+	arena_t *registros = arena_crear(sizeof(pokemon_t), cantidad);
+	if (!registros)
+		return NULL;
+	*leidos = arena_reservar_varios(registros, cantidad);
+	if (!*leidos ||
+	    fread(*leidos, sizeof(pokemon_t), cantidad, archivo) != cantidad ||
+	    sumar_registros(SUMA_INICIAL, *leidos, cantidad) !=
+		    encabezado->suma_verificacion) {
+		arena_destruir(registros);
+		return NULL;
+	}
+	return registros;
+}
+
+/*
+ * Crea un hospital a partir de un archivo guardado con
+ * hospital_guardar_binario().
+ *
+ * Devuelve NULL si el archivo no es valido o en caso de error.
+ */
+hospital_t *hospital_cargar_binario(const char *nombre_archivo)
+{
+	if (!nombre_archivo)
+		return NULL;
+	FILE *archivo = fopen(nombre_archivo, "rb");
+	if (!archivo)
+		return NULL;
+	encabezado_binario_t encabezado;
+	arena_t *registros = NULL;
+	pokemon_t *leidos = NULL;
+	if (leer_encabezado_binario(archivo, &encabezado))
+		registros = leer_registros_binarios(archivo, &encabezado,
+						    &leidos);
+	fclose(archivo);
+	if (!registros)
+		return NULL;
+
+	size_t cantidad = (size_t)encabezado.cantidad;
+	bool ordenados = (encabezado.banderas & BANDERA_ORDENADO) != 0;
+	size_t ultimo_ingreso;
+	pokemon_t **pokemones = malloc(cantidad * sizeof(pokemon_t *));
+	if (!pokemones ||
+	    !preparar_registros_binarios(leidos, cantidad, ordenados,
+					 pokemones, &ultimo_ingreso) ||
+	    (!ordenados && !ordenar_carga_por_prioridad(pokemones, cantidad))) {
+		free(pokemones);
+		arena_destruir(registros);
+		return NULL;
+	}
+
+	hospital_t *hospital = hospital_crear(pokemones, cantidad, registros);
+	free(pokemones);
+	if (!hospital) {
+		arena_destruir(registros);
+		return NULL;
+	}
+	hospital->proximo_ingreso = ultimo_ingreso + 1;
+	return hospital;
+}
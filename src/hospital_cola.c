@@ -0,0 +1,328 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CAPACIDAD_INICIAL_DRENADO 64
+
+/**
+ * Lote encolado. Los productores enlazan los lotes por siguiente; una vez que
+ * el consumidor los saca de la cola, los retiene enlazados por retenido
+ * hasta que todos sus pokemon ingresan al hospital.
+*/
+typedef struct lote_encolado {
+	struct lote_encolado *siguiente;
+	struct lote_encolado *retenido;
+	uint64_t encolado_us;
+	size_t cantidad;
+	pokemon_t *pokemones[];
+} lote_encolado_t;
+
+/**
+ * Cola MPSC intrusiva (sin locks): los productores agregan lotes en ultimo
+ * con un intercambio atomico, y el unico consumidor los saca desde primero.
+ * El centinela (un lote vacio) evita que la cola quede sin nodos y tener que
+ * coordinar productores y consumidor cuando esta vacia.
+ *
+ * Las metricas se actualizan con operaciones atomicas para poder leerlas
+ * desde cualquier hilo.
+*/
+struct cola_emergencias {
+	lote_encolado_t *ultimo;
+	lote_encolado_t *primero;
+	lote_encolado_t *centinela;
+
+	lote_encolado_t *retenidos;
+	lote_encolado_t *ultimo_retenido;
+	pokemon_t **drenados;
+	size_t capacidad_drenados;
+
+	size_t lotes_pendientes;
+	size_t pokemon_pendientes;
+	size_t lotes_ingresados;
+	size_t pokemon_ingresados;
+	uint64_t latencia_total_us;
+	uint64_t latencia_maxima_us;
+};
+
+/**
+ * Devuelve los microsegundos transcurridos desde una referencia fija.
+*/
+uint64_t microsegundos_actuales(void)
+{
+	struct timespec ahora;
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t)ahora.tv_sec * 1000000u +
+	       (uint64_t)ahora.tv_nsec / 1000u;
+}
+
+/*
+ * Crea una cola de emergencias vacia, con el centinela como unico nodo.
+ *
+ * Devuelve NULL en caso de error.
+ */
+cola_emergencias_t *cola_emergencias_crear(void)
+{
+	cola_emergencias_t *cola = calloc(1, sizeof(cola_emergencias_t));
+	if (!cola)
+		return NULL;
+	cola->centinela = calloc(1, sizeof(lote_encolado_t));
+	if (!cola->centinela) {
+		free(cola);
+		return NULL;
+	}
+	cola->ultimo = cola->centinela;
+	cola->primero = cola->centinela;
+	return cola;
+}
+
+/**
+ * Agrega el lote al final de la cola. El intercambio atomico de ultimo
+ * ordena a los productores; hasta que se enlaza el anterior con el lote, el
+ * consumidor ve la cola como si terminara antes.
+*/
+void enlazar_lote(cola_emergencias_t *cola, lote_encolado_t *lote)
+{
+	__atomic_store_n(&lote->siguiente, NULL, __ATOMIC_RELAXED);
+	lote_encolado_t *anterior =
+		__atomic_exchange_n(&cola->ultimo, lote, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&anterior->siguiente, lote, __ATOMIC_RELEASE);
+}
+
+/*
+ * Encola una copia del lote recibido, sin bloquear a otros productores.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int cola_emergencias_encolar(cola_emergencias_t *cola, pokemon_t **pokemones,
+			     size_t cantidad)
+{
+	if (!cola || (!pokemones && cantidad > 0) ||
+	    cantidad > (SIZE_MAX - sizeof(lote_encolado_t)) /
+			       sizeof(pokemon_t *))
+		return ERROR;
+	if (cantidad == 0)
+		return EXITO;
+	lote_encolado_t *lote = malloc(sizeof(lote_encolado_t) +
+				       cantidad * sizeof(pokemon_t *));
+	if (!lote)
+		return ERROR;
+	memcpy(lote->pokemones, pokemones, cantidad * sizeof(pokemon_t *));
+	lote->cantidad = cantidad;
+	lote->retenido = NULL;
+	lote->encolado_us = microsegundos_actuales();
+	__atomic_add_fetch(&cola->lotes_pendientes, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&cola->pokemon_pendientes, cantidad,
+			   __ATOMIC_RELAXED);
+	enlazar_lote(cola, lote);
+	return EXITO;
+}
+
+/**
+ * Saca el primer lote de la cola. Solo puede llamarla el consumidor.
+ *
+ * Devuelve NULL si la cola esta vacia o si el siguiente lote todavia se esta
+ * enlazando (en ese caso se saca en el proximo drenado).
+*/
+lote_encolado_t *sacar_lote(cola_emergencias_t *cola)
+{
+	lote_encolado_t *primero = cola->primero;
+	lote_encolado_t *siguiente =
+		__atomic_load_n(&primero->siguiente, __ATOMIC_ACQUIRE);
+	if (primero == cola->centinela) {
+		if (!siguiente)
+			return NULL;
+		cola->primero = siguiente;
+		primero = siguiente;
+		siguiente = __atomic_load_n(&primero->siguiente,
+					    __ATOMIC_ACQUIRE);
+	}
+	if (siguiente) {
+		cola->primero = siguiente;
+		return primero;
+	}
+	if (primero != __atomic_load_n(&cola->ultimo, __ATOMIC_ACQUIRE))
+		return NULL;
+	// El primero es el unico lote: se vuelve a encolar el centinela
+	// detras de el para poder sacarlo sin dejar la cola sin nodos.
+	enlazar_lote(cola, cola->centinela);
+	siguiente = __atomic_load_n(&primero->siguiente, __ATOMIC_ACQUIRE);
+	if (!siguiente)
+		return NULL;
+	cola->primero = siguiente;
+	return primero;
+}
+
+/**
+ * Saca todos los lotes disponibles de la cola y los agrega al final de los
+ * retenidos por el consumidor.
+ *
+ * Devuelve la cantidad de pokemon retenidos en total.
+*/
+size_t retener_lotes(cola_emergencias_t *cola)
+{
+	lote_encolado_t *lote;
+	while ((lote = sacar_lote(cola))) {
+		if (cola->ultimo_retenido)
+			cola->ultimo_retenido->retenido = lote;
+		else
+			cola->retenidos = lote;
+		cola->ultimo_retenido = lote;
+	}
+	size_t total = 0;
+	for (lote = cola->retenidos; lote; lote = lote->retenido)
+		total += lote->cantidad;
+	return total;
+}
+
+/**
+ * Copia al vector de drenado los pokemon de todos los lotes retenidos, en
+ * orden, agrandandolo si hace falta.
+ *
+ * Devuelve false en caso de error.
+*/
+bool juntar_retenidos(cola_emergencias_t *cola, size_t total)
+{
+	if (total > cola->capacidad_drenados) {
+		size_t capacidad = (cola->capacidad_drenados <
+				    CAPACIDAD_INICIAL_DRENADO) ?
+					   CAPACIDAD_INICIAL_DRENADO :
+					   cola->capacidad_drenados;
+		while (capacidad < total)
+			capacidad *= 2;
+		pokemon_t **nuevos =
+			realloc(cola->drenados, capacidad * sizeof(pokemon_t *));
+		if (!nuevos)
+			return false;
+		cola->drenados = nuevos;
+		cola->capacidad_drenados = capacidad;
+	}
+	size_t copiados = 0;
+	for (lote_encolado_t *lote = cola->retenidos; lote;
+	     lote = lote->retenido) {
+		memcpy(cola->drenados + copiados, lote->pokemones,
+		       lote->cantidad * sizeof(pokemon_t *));
+		copiados += lote->cantidad;
+	}
+	return true;
+}
+
+/**
+ * Libera los lotes retenidos, cuyos ingresados pokemon ya estan en el
+ * hospital, y actualiza las metricas. aceptar_emergencias() ingresa todos
+ * los pokemon de los lotes retenidos o ninguno, por lo que solo se llama si
+ * ingresaron todos.
+*/
+void descartar_ingresados(cola_emergencias_t *cola, size_t ingresados)
+{
+	uint64_t ahora = microsegundos_actuales();
+	size_t lotes = 0;
+	uint64_t latencia_total = 0, latencia_maxima = cola->latencia_maxima_us;
+	__atomic_sub_fetch(&cola->pokemon_pendientes, ingresados,
+			   __ATOMIC_RELAXED);
+	__atomic_add_fetch(&cola->pokemon_ingresados, ingresados,
+			   __ATOMIC_RELAXED);
+	while (cola->retenidos) {
+		lote_encolado_t *lote = cola->retenidos;
+		uint64_t latencia = (ahora > lote->encolado_us) ?
+					    ahora - lote->encolado_us :
+					    0;
+		latencia_total += latencia;
+		if (latencia > latencia_maxima)
+			latencia_maxima = latencia;
+		lotes++;
+		cola->retenidos = lote->retenido;
+		free(lote);
+	}
+	cola->ultimo_retenido = NULL;
+	__atomic_sub_fetch(&cola->lotes_pendientes, lotes, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&cola->lotes_ingresados, lotes, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&cola->latencia_total_us, latencia_total,
+			   __ATOMIC_RELAXED);
+	__atomic_store_n(&cola->latencia_maxima_us, latencia_maxima,
+			 __ATOMIC_RELAXED);
+}
+
+/*
+ * Ingresa al hospital todos los lotes encolados como un unico lote.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int cola_emergencias_drenar(cola_emergencias_t *cola, hospital_t *hospital)
+{
+	if (!cola || !hospital)
+		return ERROR;
+	size_t total = retener_lotes(cola);
+	if (total == 0)
+		return EXITO;
+	if (!juntar_retenidos(cola, total))
+		return ERROR;
+	size_t ingresados;
+	bloquear_escritura(hospital);
+	int resultado = aceptar_emergencias(hospital, cola->drenados, total,
+					    &ingresados);
+	desbloquear_escritura(hospital);
+	if (ingresados > 0)
+		descartar_ingresados(cola, ingresados);
+	return resultado;
+}
+
+/*
+ * Guarda en *metricas las metricas actuales de la cola.
+ */
+void cola_emergencias_metricas(cola_emergencias_t *cola,
+			       metricas_cola_t *metricas)
+{
+	if (!cola || !metricas)
+		return;
+	metricas->lotes_pendientes =
+		__atomic_load_n(&cola->lotes_pendientes, __ATOMIC_RELAXED);
+	metricas->pokemon_pendientes =
+		__atomic_load_n(&cola->pokemon_pendientes, __ATOMIC_RELAXED);
+	metricas->lotes_ingresados =
+		__atomic_load_n(&cola->lotes_ingresados, __ATOMIC_RELAXED);
+	metricas->pokemon_ingresados =
+		__atomic_load_n(&cola->pokemon_ingresados, __ATOMIC_RELAXED);
+	uint64_t latencia_total =
+		__atomic_load_n(&cola->latencia_total_us, __ATOMIC_RELAXED);
+	metricas->latencia_promedio_us =
+		(metricas->lotes_ingresados > 0) ?
+			(size_t)(latencia_total / metricas->lotes_ingresados) :
+			0;
+	metricas->latencia_maxima_us = (size_t)__atomic_load_n(
+		&cola->latencia_maxima_us, __ATOMIC_RELAXED);
+}
+
+/**
+ * Libera el lote junto con los pokemon que contiene.
+*/
+void destruir_lote_encolado(lote_encolado_t *lote)
+{
+	for (size_t i = 0; i < lote->cantidad; i++)
+		pokemon_destruir(lote->pokemones[i]);
+	free(lote);
+}
+
+/*
+ * Destruye la cola y los pokemon que no llegaron a ingresar.
+ */
+void cola_emergencias_destruir(cola_emergencias_t *cola)
+{
+	if (!cola)
+		return;
+	retener_lotes(cola);
+	while (cola->retenidos) {
+		lote_encolado_t *lote = cola->retenidos;
+		cola->retenidos = lote->retenido;
+		destruir_lote_encolado(lote);
+	}
+	free(cola->drenados);
+	free(cola->centinela);
+	free(cola);
+}
@@ -0,0 +1,159 @@
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * Cerrojo de lectores y escritor de un hospital concurrente, con preferencia
+ * para los escritores: mientras haya un escritor esperando no entran nuevos
+ * lectores, por lo que un flujo continuo de lecturas no puede postergar
+ * indefinidamente una escritura.
+ *
+ * El mutex de construccion ordena a los lectores que encuentran un indice sin
+ * construir, para que se construya una sola vez.
+*/
+struct cerrojo_hospital {
+	pthread_mutex_t mutex;
+	pthread_cond_t puede_leer;
+	pthread_cond_t puede_escribir;
+	size_t lectores;
+	size_t escritores_esperando;
+	bool escribiendo;
+	pthread_mutex_t construccion;
+};
+
+/*
+ * Habilita el uso del hospital desde varios hilos a la vez.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int hospital_habilitar_concurrencia(hospital_t *hospital)
+{
+	if (!hospital || hospital->vista)
+		return ERROR;
+	if (hospital->cerrojo)
+		return EXITO;
+	cerrojo_hospital_t *cerrojo = calloc(1, sizeof(cerrojo_hospital_t));
+	if (!cerrojo)
+		return ERROR;
+	bool mutex = pthread_mutex_init(&cerrojo->mutex, NULL) == 0;
+	bool leer = pthread_cond_init(&cerrojo->puede_leer, NULL) == 0;
+	bool escribir = pthread_cond_init(&cerrojo->puede_escribir, NULL) == 0;
+	bool construccion =
+		pthread_mutex_init(&cerrojo->construccion, NULL) == 0;
+	if (mutex && leer && escribir && construccion) {
+		hospital->cerrojo = cerrojo;
+		return EXITO;
+	}
+	if (mutex)
+		pthread_mutex_destroy(&cerrojo->mutex);
+	if (leer)
+		pthread_cond_destroy(&cerrojo->puede_leer);
+	if (escribir)
+		pthread_cond_destroy(&cerrojo->puede_escribir);
+	if (construccion)
+		pthread_mutex_destroy(&cerrojo->construccion);
+	free(cerrojo);
+	return ERROR;
+}
+
+/*
+ * Toma el cerrojo del hospital para leer, esperando a que no haya un
+ * escritor activo ni esperando. No hace nada si el hospital no es
+ * concurrente.
+ */
+void bloquear_lectura(hospital_t *hospital)
+{
+	if (!hospital || !hospital->cerrojo)
+		return;
+	cerrojo_hospital_t *cerrojo = hospital->cerrojo;
+	pthread_mutex_lock(&cerrojo->mutex);
+	while (cerrojo->escribiendo || cerrojo->escritores_esperando > 0)
+		pthread_cond_wait(&cerrojo->puede_leer, &cerrojo->mutex);
+	cerrojo->lectores++;
+	pthread_mutex_unlock(&cerrojo->mutex);
+}
+
+/*
+ * Suelta el cerrojo de lectura. El ultimo lector en salir despierta a un
+ * escritor que este esperando.
+ */
+void desbloquear_lectura(hospital_t *hospital)
+{
+	if (!hospital || !hospital->cerrojo)
+		return;
+	cerrojo_hospital_t *cerrojo = hospital->cerrojo;
+	pthread_mutex_lock(&cerrojo->mutex);
+	cerrojo->lectores--;
+	if (cerrojo->lectores == 0 && cerrojo->escritores_esperando > 0)
+		pthread_cond_signal(&cerrojo->puede_escribir);
+	pthread_mutex_unlock(&cerrojo->mutex);
+}
+
+/*
+ * Toma el cerrojo del hospital para escribir, esperando a que salgan los
+ * lectores y el escritor activos. Mientras espera, no entran nuevos lectores.
+ */
+void bloquear_escritura(hospital_t *hospital)
+{
+	if (!hospital || !hospital->cerrojo)
+		return;
+	cerrojo_hospital_t *cerrojo = hospital->cerrojo;
+	pthread_mutex_lock(&cerrojo->mutex);
+	cerrojo->escritores_esperando++;
+	while (cerrojo->escribiendo || cerrojo->lectores > 0)
+		pthread_cond_wait(&cerrojo->puede_escribir, &cerrojo->mutex);
+	cerrojo->escritores_esperando--;
+	cerrojo->escribiendo = true;
+	pthread_mutex_unlock(&cerrojo->mutex);
+}
+
+/*
+ * Suelta el cerrojo de escritura. Si hay otro escritor esperando pasa el
+ * primero; si no, entran todos los lectores que esperaban.
+ */
+void desbloquear_escritura(hospital_t *hospital)
+{
+	if (!hospital || !hospital->cerrojo)
+		return;
+	cerrojo_hospital_t *cerrojo = hospital->cerrojo;
+	pthread_mutex_lock(&cerrojo->mutex);
+	cerrojo->escribiendo = false;
+	if (cerrojo->escritores_esperando > 0)
+		pthread_cond_signal(&cerrojo->puede_escribir);
+	else
+		pthread_cond_broadcast(&cerrojo->puede_leer);
+	pthread_mutex_unlock(&cerrojo->mutex);
+}
+
+/*
+ * Toma y suelta el mutex de construccion de indices. No hacen nada si el
+ * hospital no es concurrente.
+ */
+void bloquear_construccion(hospital_t *hospital)
+{
+	if (hospital->cerrojo)
+		pthread_mutex_lock(&hospital->cerrojo->construccion);
+}
+
+void desbloquear_construccion(hospital_t *hospital)
+{
+	if (hospital->cerrojo)
+		pthread_mutex_unlock(&hospital->cerrojo->construccion);
+}
+
+/*
+ * Libera el cerrojo. Ningun hilo debe estar usandolo.
+ */
+void cerrojo_destruir(cerrojo_hospital_t *cerrojo)
+{
+	if (!cerrojo)
+		return;
+	pthread_mutex_destroy(&cerrojo->mutex);
+	pthread_cond_destroy(&cerrojo->puede_leer);
+	pthread_cond_destroy(&cerrojo->puede_escribir);
+	pthread_mutex_destroy(&cerrojo->construccion);
+	free(cerrojo);
+}
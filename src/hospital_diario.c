@@ -0,0 +1,574 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FIRMA_DIARIO "HOSPDIA"
+#define VERSION_DIARIO 2
+#define FIRMA_LOTE 0x45544f4cu
+#define MILISEGUNDOS_POR_SEGUNDO 1000
+#define NANOSEGUNDOS_POR_MILISEGUNDO 1000000L
+#define NANOSEGUNDOS_POR_SEGUNDO 1000000000L
+
+/**
+ * Encabezado de cada lote del diario. Le siguen cantidad registros binarios,
+ * con el mismo formato que los de hospital_guardar_binario(). De los pokemon
+ * de un lote de actualizacion solo se usan el id y la nueva salud.
+*/
+typedef struct encabezado_lote {
+	uint32_t firma;
+	uint32_t tipo;
+	uint64_t cantidad;
+	uint64_t suma_verificacion;
+} encabezado_lote_t;
+
+/**
+ * Diario de emergencias de un hospital. Cada lote se arma completo en el
+ * buffer (encabezado y registros) y se agrega al archivo con una sola
+ * escritura; la sincronizacion con el disco depende de la politica elegida.
+ *
+ * Con SINCRONIZAR_PERIODICAMENTE un hilo sincronizador espera a que haya
+ * lotes pendientes y los sincroniza a lo sumo intervalo_ms milisegundos
+ * despues de la sincronizacion anterior, aunque no lleguen nuevos lotes. El
+ * mutex protege las banderas que comparte con el hilo que escribe.
+*/
+struct diario {
+	int descriptor;
+	int sincronizacion;
+	size_t intervalo_ms;
+	char *buffer;
+	size_t capacidad;
+	pthread_t sincronizador;
+	pthread_mutex_t mutex;
+	pthread_cond_t cambio;
+	bool pendiente;
+	bool cerrando;
+	bool fallo_sincronizacion;
+};
+
+/**
+ * Devuelve el instante que resulta de sumarle los milisegundos indicados a
+ * la referencia.
+*/
+struct timespec sumar_milisegundos(struct timespec referencia,
+				   size_t milisegundos)
+{
+	referencia.tv_sec += (time_t)(milisegundos / MILISEGUNDOS_POR_SEGUNDO);
+	referencia.tv_nsec += (long)(milisegundos % MILISEGUNDOS_POR_SEGUNDO) *
+			      NANOSEGUNDOS_POR_MILISEGUNDO;
+	if (referencia.tv_nsec >= NANOSEGUNDOS_POR_SEGUNDO) {
+		referencia.tv_sec++;
+		referencia.tv_nsec -= NANOSEGUNDOS_POR_SEGUNDO;
+	}
+	return referencia;
+}
+
+/**
+ * Escribe todos los bytes indicados en el descriptor, reintentando las
+ * escrituras parciales o interrumpidas.
+ *
+ * Devuelve false en caso de error.
+*/
+bool escribir_completo(int descriptor, const char *datos, size_t tamanio)
+{
+	while (tamanio > 0) {
+		ssize_t escritos = write(descriptor, datos, tamanio);
+		if (escritos < 0 && errno == EINTR)
+			continue;
+		if (escritos <= 0)
+			return false;
+		datos += escritos;
+		tamanio -= (size_t)escritos;
+	}
+	return true;
+}
+
+/**
+ * Devuelve un encabezado de archivo de diario.
+*/
+encabezado_binario_t encabezado_diario(void)
+{
+	encabezado_binario_t encabezado = { 0 };
+	memcpy(encabezado.firma, FIRMA_DIARIO, sizeof(FIRMA_DIARIO));
+	encabezado.version = VERSION_DIARIO;
+	encabezado.tamanio_registro = sizeof(pokemon_t);
+	return encabezado;
+}
+
+/**
+ * Devuelve true si el encabezado leido es el de un diario compatible.
+*/
+bool encabezado_diario_valido(const encabezado_binario_t *encabezado)
+{
+	encabezado_binario_t esperado = encabezado_diario();
+	return memcmp(encabezado, &esperado, sizeof(esperado)) == 0;
+}
+
+/**
+ * Prepara el archivo abierto en el descriptor para agregarle lotes: si esta
+ * vacio le escribe el encabezado y si no verifica que sea un diario.
+ *
+ * Devuelve false si el archivo no es un diario o en caso de error.
+*/
+bool preparar_archivo_diario(int descriptor)
+{
+	encabezado_binario_t encabezado;
+	ssize_t leidos;
+	do {
+		leidos = pread(descriptor, &encabezado, sizeof(encabezado), 0);
+	} while (leidos < 0 && errno == EINTR);
+	if (leidos == 0) {
+		encabezado = encabezado_diario();
+		return escribir_completo(descriptor, (const char *)&encabezado,
+					 sizeof(encabezado)) &&
+		       fdatasync(descriptor) == 0;
+	}
+	return leidos == sizeof(encabezado) &&
+	       encabezado_diario_valido(&encabezado);
+}
+
+/**
+ * Sincroniza con el disco los lotes pendientes del diario, a lo sumo
+ * intervalo_ms milisegundos despues de la sincronizacion anterior, hasta que
+ * el diario se cierre. Si una sincronizacion falla lo indica en el diario.
+ * Tiene la firma de las funciones que ejecuta pthread_create().
+*/
+void *sincronizar_periodicamente(void *argumento)
+{
+	diario_t *diario = argumento;
+	struct timespec ultima_sincronizacion;
+	clock_gettime(CLOCK_MONOTONIC, &ultima_sincronizacion);
+	pthread_mutex_lock(&diario->mutex);
+	while (!diario->cerrando) {
+		if (!diario->pendiente) {
+			pthread_cond_wait(&diario->cambio, &diario->mutex);
+			continue;
+		}
+		struct timespec limite = sumar_milisegundos(
+			ultima_sincronizacion, diario->intervalo_ms);
+		if (pthread_cond_timedwait(&diario->cambio, &diario->mutex,
+					   &limite) != ETIMEDOUT)
+			continue;
+		diario->pendiente = false;
+		pthread_mutex_unlock(&diario->mutex);
+		bool sincronizado = fdatasync(diario->descriptor) == 0;
+		clock_gettime(CLOCK_MONOTONIC, &ultima_sincronizacion);
+		pthread_mutex_lock(&diario->mutex);
+		if (!sincronizado)
+			diario->fallo_sincronizacion = true;
+	}
+	pthread_mutex_unlock(&diario->mutex);
+	return NULL;
+}
+
+/**
+ * Crea el mutex, la condicion (sobre el reloj monotonico) y el hilo
+ * sincronizador de un diario con SINCRONIZAR_PERIODICAMENTE.
+ *
+ * Devuelve false en caso de error; en ese caso no queda nada creado.
+*/
+bool iniciar_sincronizador(diario_t *diario)
+{
+	pthread_condattr_t atributos;
+	if (pthread_condattr_init(&atributos) != 0)
+		return false;
+	bool reloj = pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC) ==
+		     0;
+	bool condicion = reloj &&
+			 pthread_cond_init(&diario->cambio, &atributos) == 0;
+	pthread_condattr_destroy(&atributos);
+	bool mutex = pthread_mutex_init(&diario->mutex, NULL) == 0;
+	if (condicion && mutex &&
+	    pthread_create(&diario->sincronizador, NULL,
+			   sincronizar_periodicamente, diario) == 0)
+		return true;
+	if (condicion)
+		pthread_cond_destroy(&diario->cambio);
+	if (mutex)
+		pthread_mutex_destroy(&diario->mutex);
+	return false;
+}
+
+/**
+ * Detiene el hilo sincronizador de un diario con SINCRONIZAR_PERIODICAMENTE
+ * y libera su mutex y su condicion. Los lotes pendientes quedan sin
+ * sincronizar.
+*/
+void detener_sincronizador(diario_t *diario)
+{
+	pthread_mutex_lock(&diario->mutex);
+	diario->cerrando = true;
+	pthread_cond_signal(&diario->cambio);
+	pthread_mutex_unlock(&diario->mutex);
+	pthread_join(diario->sincronizador, NULL);
+	pthread_cond_destroy(&diario->cambio);
+	pthread_mutex_destroy(&diario->mutex);
+}
+
+/**
+ * Abre el diario como hospital_abrir_diario(), sin tomar el cerrojo.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+*/
+int abrir_diario(hospital_t *hospital, const char *nombre_archivo,
+		 int sincronizacion, size_t intervalo_ms)
+{
+	if (!hospital || !nombre_archivo || hospital->vista ||
+	    hospital->diario ||
+	    (sincronizacion != SINCRONIZAR_CADA_LOTE &&
+	     sincronizacion != SINCRONIZAR_PERIODICAMENTE &&
+	     sincronizacion != SINCRONIZAR_NUNCA))
+		return ERROR;
+	diario_t *diario = calloc(1, sizeof(diario_t));
+	if (!diario)
+		return ERROR;
+	diario->descriptor =
+		open(nombre_archivo, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (diario->descriptor < 0) {
+		free(diario);
+		return ERROR;
+	}
+	if (!preparar_archivo_diario(diario->descriptor)) {
+		close(diario->descriptor);
+		free(diario);
+		return ERROR;
+	}
+	diario->sincronizacion = sincronizacion;
+	diario->intervalo_ms = intervalo_ms;
+	if (sincronizacion == SINCRONIZAR_PERIODICAMENTE &&
+	    !iniciar_sincronizador(diario)) {
+		close(diario->descriptor);
+		free(diario);
+		return ERROR;
+	}
+	hospital->diario = diario;
+	return EXITO;
+}
+
+/*
+ * Empieza a registrar en un diario las emergencias del hospital.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int hospital_abrir_diario(hospital_t *hospital, const char *nombre_archivo,
+			  int sincronizacion, size_t intervalo_ms)
+{
+	bloquear_escritura(hospital);
+	int resultado = abrir_diario(hospital, nombre_archivo, sincronizacion,
+				     intervalo_ms);
+	desbloquear_escritura(hospital);
+	return resultado;
+}
+
+/**
+ * Devuelve false si el hilo sincronizador no pudo sincronizar alguno de los
+ * lotes ya escritos. En ese caso el diario no acepta nuevos lotes.
+*/
+bool diario_sincronizado(diario_t *diario)
+{
+	if (diario->sincronizacion != SINCRONIZAR_PERIODICAMENTE)
+		return true;
+	pthread_mutex_lock(&diario->mutex);
+	bool sincronizado = !diario->fallo_sincronizacion;
+	pthread_mutex_unlock(&diario->mutex);
+	return sincronizado;
+}
+
+/**
+ * Sincroniza el archivo del diario con el disco para el lote recien escrito,
+ * o se lo encarga al hilo sincronizador, segun la politica del diario.
+ *
+ * Devuelve false en caso de error.
+*/
+bool sincronizar_diario(diario_t *diario)
+{
+	if (diario->sincronizacion == SINCRONIZAR_CADA_LOTE)
+		return fdatasync(diario->descriptor) == 0;
+	if (diario->sincronizacion == SINCRONIZAR_PERIODICAMENTE) {
+		pthread_mutex_lock(&diario->mutex);
+		diario->pendiente = true;
+		pthread_cond_signal(&diario->cambio);
+		pthread_mutex_unlock(&diario->mutex);
+	}
+	return true;
+}
+
+/*
+ * Agrega al diario un lote del tipo indicado con los pokemon recibidos: antes
+ * de aplicarlo al hospital o, si es de emergencias, despues de ingresarlo.
+ *
+ * Devuelve false en caso de error.
+ */
+bool diario_registrar_lote(diario_t *diario, uint32_t tipo,
+			   pokemon_t **pokemones, size_t cantidad)
+{
+	if (cantidad == 0)
+		return true;
+	if (!diario_sincronizado(diario) ||
+	    cantidad >
+		    (SIZE_MAX - sizeof(encabezado_lote_t)) / sizeof(pokemon_t))
+		return false;
+	size_t tamanio =
+		sizeof(encabezado_lote_t) + cantidad * sizeof(pokemon_t);
+	if (tamanio > diario->capacidad) {
+		char *nuevo_buffer = realloc(diario->buffer, tamanio);
+		if (!nuevo_buffer)
+			return false;
+		diario->buffer = nuevo_buffer;
+		diario->capacidad = tamanio;
+	}
+	pokemon_t *registros =
+		(pokemon_t *)(diario->buffer + sizeof(encabezado_lote_t));
+	for (size_t i = 0; i < cantidad; i++) {
+		if (!pokemones[i])
+			return false;
+		copiar_registro_binario(&registros[i], pokemones[i]);
+	}
+	encabezado_lote_t encabezado = {
+		.firma = FIRMA_LOTE,
+		.tipo = tipo,
+		.cantidad = cantidad,
+		.suma_verificacion =
+			sumar_registros(SUMA_INICIAL, registros, cantidad),
+	};
+	memcpy(diario->buffer, &encabezado, sizeof(encabezado));
+	return escribir_completo(diario->descriptor, diario->buffer, tamanio) &&
+	       sincronizar_diario(diario);
+}
+
+/*
+ * Cierra el diario, sincronizandolo antes con el disco salvo que la politica
+ * sea no sincronizar nunca.
+ */
+void diario_cerrar(diario_t *diario)
+{
+	if (!diario)
+		return;
+	if (diario->sincronizacion == SINCRONIZAR_PERIODICAMENTE)
+		detener_sincronizador(diario);
+	if (diario->sincronizacion != SINCRONIZAR_NUNCA)
+		fdatasync(diario->descriptor);
+	close(diario->descriptor);
+	free(diario->buffer);
+	free(diario);
+}
+
+/**
+ * Crea los pokemon de un lote leido del diario, cada uno con su propia
+ * memoria como los que llegan en ambulancia.
+ *
+ * Devuelve false en caso de error; en ese caso no queda ningun pokemon
+ * creado.
+*/
+bool crear_pokemon_de_lote(const pokemon_t *registros, size_t cantidad,
+			   pokemon_t **pokemones)
+{
+	for (size_t i = 0; i < cantidad; i++) {
+		pokemones[i] = malloc(sizeof(pokemon_t));
+		if (!pokemones[i]) {
+			for (size_t j = 0; j < i; j++)
+				pokemon_destruir(pokemones[j]);
+			return false;
+		}
+		*pokemones[i] = registros[i];
+	}
+	return true;
+}
+
+/**
+ * Devuelve true si el encabezado del lote, leido en la posicion indicada de
+ * un diario del tamaño indicado (0 si no se conoce), es valido y sus
+ * registros entran en lo que queda del archivo.
+*/
+bool encabezado_lote_valido(const encabezado_lote_t *encabezado,
+			    long posicion, size_t tamanio)
+{
+	if (encabezado->firma != FIRMA_LOTE ||
+	    encabezado->tipo > LOTE_ACTUALIZACION ||
+	    encabezado->cantidad == 0 ||
+	    encabezado->cantidad > SIZE_MAX / sizeof(pokemon_t))
+		return false;
+	if (tamanio == 0)
+		return true;
+	return posicion >= 0 && (size_t)posicion <= tamanio &&
+	       encabezado->cantidad <=
+		       (tamanio - (size_t)posicion) / sizeof(pokemon_t);
+}
+
+/**
+ * Lee del diario (del tamaño indicado, o 0 si no se conoce) el siguiente
+ * lote en los vectores recibidos (que crecen si hace falta) y crea sus
+ * pokemon en *pokemones. Guarda en *tipo el tipo del lote y en *cantidad la
+ * cantidad de pokemon del lote, o 0 al llegar al final del diario o a un
+ * lote incompleto o corrupto (por ejemplo, el que se estaba escribiendo al
+ * interrumpirse el programa).
+ *
+ * Devuelve false en caso de error (sin memoria para leer el lote), que no
+ * debe confundirse con el final del diario.
+*/
+bool leer_lote(FILE *archivo, size_t tamanio, pokemon_t **registros,
+	       pokemon_t ***pokemones, size_t *capacidad, uint32_t *tipo,
+	       size_t *cantidad)
+{
+	*cantidad = 0;
+	encabezado_lote_t encabezado;
+	if (fread(&encabezado, sizeof(encabezado), 1, archivo) != 1 ||
+	    !encabezado_lote_valido(&encabezado, ftell(archivo), tamanio))
+		return true;
+	size_t leidos = (size_t)encabezado.cantidad;
+	if (leidos > *capacidad) {
+		pokemon_t *nuevos_registros =
+			realloc(*registros, sizeof(pokemon_t) * leidos);
+		if (nuevos_registros)
+			*registros = nuevos_registros;
+		pokemon_t **nuevos_pokemones =
+			realloc(*pokemones, sizeof(pokemon_t *) * leidos);
+		if (nuevos_pokemones)
+			*pokemones = nuevos_pokemones;
+		if (!nuevos_registros || !nuevos_pokemones)
+			return false;
+		*capacidad = leidos;
+	}
+	if (fread(*registros, sizeof(pokemon_t), leidos, archivo) != leidos ||
+	    sumar_registros(SUMA_INICIAL, *registros, leidos) !=
+		    encabezado.suma_verificacion)
+		return true;
+	for (size_t i = 0; i < leidos; i++)
+		if (!registro_binario_valido(&(*registros)[i]))
+			return true;
+	if (!crear_pokemon_de_lote(*registros, leidos, *pokemones))
+		return false;
+	*tipo = encabezado.tipo;
+	*cantidad = leidos;
+	return true;
+}
+
+/**
+ * Ingresa al hospital los pokemon de un lote del diario. Si alguno no puede
+ * ingresar, se liberan los que todavia no ingresaron.
+ *
+ * Devuelve false en caso de error.
+*/
+bool ingresar_lote(hospital_t *hospital, pokemon_t **pokemones,
+		   size_t cantidad)
+{
+	for (size_t i = 0; i < cantidad; i++) {
+		if (!ingresar_pokemon(hospital, pokemones[i])) {
+			for (size_t j = i; j < cantidad; j++)
+				pokemon_destruir(pokemones[j]);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Atiende en el hospital un pokemon por cada pokemon de un lote de atencion
+ * del diario, o le cambia la salud a cada pokemon de un lote de
+ * actualizacion. Los pokemon del lote se liberan.
+ *
+ * Devuelve false si alguna operacion no se puede aplicar (el diario no
+ * corresponde al archivo base) o en caso de error.
+*/
+bool aplicar_operaciones(hospital_t *hospital, uint32_t tipo,
+			 pokemon_t **pokemones, size_t cantidad)
+{
+	bool exito = true;
+	for (size_t i = 0; i < cantidad; i++) {
+		if (exito && tipo == LOTE_ATENCION) {
+			pokemon_t *atendido = hospital_atender_siguiente(hospital);
+			exito = atendido != NULL;
+			pokemon_destruir(atendido);
+		} else if (exito) {
+			exito = hospital_actualizar_salud(
+					hospital, pokemones[i]->id,
+					pokemones[i]->salud) == EXITO;
+		}
+		pokemon_destruir(pokemones[i]);
+	}
+	return exito;
+}
+
+/**
+ * Aplica al hospital los lotes del diario, en orden, hasta el final o hasta
+ * el primer lote incompleto o corrupto. En ese caso el diario se trunca
+ * despues del ultimo lote valido, para que los lotes que se agreguen luego
+ * puedan volver a leerse. Si falla la lectura de un lote (por falta de
+ * memoria) el diario no se trunca, ya que sus lotes pueden ser validos. Si
+ * el diario no existe no hay nada que aplicar.
+ *
+ * Devuelve false si el archivo no es un diario o en caso de error.
+*/
+bool aplicar_diario(hospital_t *hospital, const char *nombre_diario)
+{
+	FILE *archivo = fopen(nombre_diario, "rb");
+	if (!archivo)
+		return errno == ENOENT;
+	encabezado_binario_t encabezado;
+	if (fread(&encabezado, sizeof(encabezado), 1, archivo) != 1 ||
+	    !encabezado_diario_valido(&encabezado)) {
+		fclose(archivo);
+		return false;
+	}
+
+	pokemon_t *registros = NULL;
+	pokemon_t **pokemones = NULL;
+	size_t capacidad = 0, cantidad = 0;
+	uint32_t tipo = LOTE_EMERGENCIAS;
+	size_t tamanio = tamanio_archivo(fileno(archivo));
+	long fin_valido = ftell(archivo);
+	bool exito = fin_valido >= 0;
+	while (exito) {
+		exito = leer_lote(archivo, tamanio, &registros, &pokemones,
+				  &capacidad, &tipo, &cantidad);
+		if (!exito || cantidad == 0)
+			break;
+		exito = (tipo == LOTE_EMERGENCIAS) ?
+				ingresar_lote(hospital, pokemones, cantidad) :
+				aplicar_operaciones(hospital, tipo, pokemones,
+						    cantidad);
+		fin_valido = ftell(archivo);
+	}
+	exito = exito && fin_valido >= 0 && fseek(archivo, 0, SEEK_END) == 0;
+	bool completo = exito && ftell(archivo) == fin_valido;
+	fclose(archivo);
+	free(registros);
+	free(pokemones);
+	if (exito && !completo)
+		exito = truncate(nombre_diario, (off_t)fin_valido) == 0;
+	return exito;
+}
+
+/*
+ * Crea un hospital a partir de un archivo base (binario o CSV) y le aplica
+ * las emergencias registradas en el diario.
+ *
+ * Devuelve NULL en caso de error.
+ */
+hospital_t *hospital_recuperar(const char *archivo_base,
+			       const char *nombre_diario)
+{
+	if (!archivo_base || !nombre_diario)
+		return NULL;
+	hospital_t *hospital = hospital_cargar_binario(archivo_base);
+	if (!hospital)
+		hospital = hospital_crear_desde_archivo(archivo_base);
+	if (!hospital)
+		return NULL;
+	if (!aplicar_diario(hospital, nombre_diario)) {
+		hospital_destruir(hospital);
+		return NULL;
+	}
+	return hospital;
+}
@@ -0,0 +1,338 @@
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include "lista.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Estadisticas que el hospital mantiene de cada entrenador con pokemon
+ * internados: la cantidad, la suma de sus saludes (para el promedio), la
+ * salud minima y cuantos pokemon tienen esa salud.
+*/
+typedef struct registro_entrenador {
+	size_t cantidad;
+	size_t suma_salud;
+	size_t salud_minima;
+	size_t con_salud_minima;
+} registro_entrenador_t;
+
+/**
+ * Agrega una salud al minimo del registro.
+*/
+void acumular_minimo(registro_entrenador_t *registro, size_t salud)
+{
+	if (registro->con_salud_minima == 0 || salud < registro->salud_minima) {
+		registro->salud_minima = salud;
+		registro->con_salud_minima = 1;
+	} else if (salud == registro->salud_minima) {
+		registro->con_salud_minima++;
+	}
+}
+
+/**
+ * Suma el pokemon al registro. Tiene la firma de las funciones de los
+ * recorridos del hospital.
+*/
+bool sumar_pokemon_a_registro(pokemon_t *pokemon, void *registro)
+{
+	registro_entrenador_t *datos = registro;
+	datos->cantidad++;
+	datos->suma_salud += pokemon->salud;
+	acumular_minimo(datos, pokemon->salud);
+	return true;
+}
+
+/*
+ * Suma el pokemon a las estadisticas de su entrenador, en O(1), creando el
+ * registro del entrenador si es su primer pokemon.
+ *
+ * Devuelve false en caso de error.
+ */
+bool sumar_a_entrenador(hospital_t *hospital, pokemon_t *pokemon)
+{
+	registro_entrenador_t *registro =
+		hash_obtener(hospital->estadisticas, pokemon->nombre_entrenador);
+	if (!registro) {
+		registro = calloc(1, sizeof(registro_entrenador_t));
+		if (!registro)
+			return false;
+		if (!hash_insertar(hospital->estadisticas,
+				   pokemon->nombre_entrenador, registro, NULL)) {
+			free(registro);
+			return false;
+		}
+		hospital->cantidad_entrenadores++;
+	}
+	return sumar_pokemon_a_registro(pokemon, registro);
+}
+
+/**
+ * Pokemon que se recorren para recalcular el minimo de un entrenador: los de
+ * su lista del indice por entrenador o, si no se pudo construir el indice,
+ * todos los del hospital (y se filtran los del entrenador).
+*/
+typedef struct recalculo_minimo {
+	const char *entrenador;
+	registro_entrenador_t *registro;
+} recalculo_minimo_t;
+
+bool acumular_minimo_de_entrenador(void *pokemon, void *recalculo)
+{
+	recalculo_minimo_t *datos = recalculo;
+	pokemon_t *actual = pokemon;
+	if (!datos->entrenador ||
+	    strcmp(actual->nombre_entrenador, datos->entrenador) == 0)
+		acumular_minimo(datos->registro, actual->salud);
+	return true;
+}
+
+/**
+ * Recalcula el minimo del entrenador cuando deja el hospital (o cambia su
+ * salud) el ultimo de sus pokemon con la salud minima. Recorre solo los
+ * pokemon del entrenador, con el indice por entrenador.
+*/
+void recalcular_minimo(hospital_t *hospital, const char *entrenador,
+		       registro_entrenador_t *registro)
+{
+	registro->con_salud_minima = 0;
+	hash_t *indice = obtener_indice(hospital, &hospital->indice_entrenador,
+					indexar_entrenador);
+	recalculo_minimo_t recalculo = { .registro = registro };
+	if (indice) {
+		lista_con_cada_elemento(hash_obtener(indice, entrenador),
+					acumular_minimo_de_entrenador,
+					&recalculo);
+		return;
+	}
+	recalculo.entrenador = entrenador;
+	abb_con_cada_elemento(hospital->prioridades,
+			      acumular_minimo_de_entrenador, &recalculo);
+}
+
+/*
+ * Resta de las estadisticas del entrenador un pokemon con la salud indicada,
+ * que ya no esta en el hospital (ni en sus indices). Si era su ultimo
+ * pokemon, descarta el registro.
+ */
+void restar_de_entrenador(hospital_t *hospital, const char *entrenador,
+			  size_t salud)
+{
+	registro_entrenador_t *registro =
+		hash_obtener(hospital->estadisticas, entrenador);
+	if (!registro)
+		return;
+	registro->cantidad--;
+	registro->suma_salud -= salud;
+	if (registro->cantidad == 0) {
+		free(hash_quitar(hospital->estadisticas, entrenador));
+		hospital->cantidad_entrenadores--;
+		return;
+	}
+	if (salud == registro->salud_minima &&
+	    --registro->con_salud_minima == 0)
+		recalcular_minimo(hospital, entrenador, registro);
+}
+
+/*
+ * Actualiza las estadisticas del entrenador del pokemon, que ya tiene su
+ * nueva salud, cuando antes tenia la salud anterior indicada.
+ */
+void cambiar_salud_de_entrenador(hospital_t *hospital,
+				 const pokemon_t *pokemon,
+				 size_t salud_anterior)
+{
+	registro_entrenador_t *registro =
+		hash_obtener(hospital->estadisticas, pokemon->nombre_entrenador);
+	if (!registro || pokemon->salud == salud_anterior)
+		return;
+	registro->suma_salud = registro->suma_salud - salud_anterior +
+			       pokemon->salud;
+	bool era_minima = salud_anterior == registro->salud_minima;
+	acumular_minimo(registro, pokemon->salud);
+	if (era_minima && salud_anterior == registro->salud_minima &&
+	    --registro->con_salud_minima == 0)
+		recalcular_minimo(hospital, pokemon->nombre_entrenador,
+				  registro);
+}
+
+/**
+ * Estado de preparar_fusion_estadisticas(): el hash destino y si todos los
+ * registros pudieron moverse.
+*/
+typedef struct movimiento_registros {
+	hash_t *destino;
+	bool exito;
+} movimiento_registros_t;
+
+/**
+ * Funcion utilizada por preparar_fusion_estadisticas() que pasa al hash
+ * destino el registro de un entrenador que no tiene pokemon en el destino.
+*/
+bool mover_registro_nuevo(const char *entrenador, void *registro,
+			  void *movimiento)
+{
+	movimiento_registros_t *datos = movimiento;
+	if (!hash_obtener(datos->destino, entrenador))
+		datos->exito = hash_insertar(datos->destino, entrenador,
+					     registro, NULL) != NULL;
+	return datos->exito;
+}
+
+/**
+ * Funcion utilizada por deshacer_fusion_estadisticas() que quita del hash
+ * destino los registros que se movieron desde el origen.
+*/
+bool quitar_registro_movido(const char *entrenador, void *registro,
+			    void *destino)
+{
+	if (hash_obtener(destino, entrenador) == registro)
+		hash_quitar(destino, entrenador);
+	return true;
+}
+
+/*
+ * Primera parte de la fusion de las estadisticas del origen en las del
+ * destino: mueve al destino los registros de los entrenadores que solo
+ * tienen pokemon en el origen, que es la unica parte que puede fallar. Si
+ * falla, deja ambos hospitales como estaban.
+ *
+ * Devuelve false en caso de error.
+ */
+bool preparar_fusion_estadisticas(hospital_t *destino, hospital_t *origen)
+{
+	movimiento_registros_t movimiento = { .destino = destino->estadisticas,
+					      .exito = true };
+	hash_con_cada_clave(origen->estadisticas, mover_registro_nuevo,
+			    &movimiento);
+	if (!movimiento.exito)
+		deshacer_fusion_estadisticas(destino, origen);
+	return movimiento.exito;
+}
+
+/*
+ * Quita del destino los registros movidos por preparar_fusion_estadisticas(),
+ * que siguen perteneciendo al origen.
+ */
+void deshacer_fusion_estadisticas(hospital_t *destino, hospital_t *origen)
+{
+	hash_con_cada_clave(origen->estadisticas, quitar_registro_movido,
+			    destino->estadisticas);
+}
+
+/**
+ * Funcion utilizada por completar_fusion_estadisticas() que suma el registro
+ * del origen al del mismo entrenador en el destino (si no es el mismo
+ * registro, ya movido) y lo libera.
+*/
+bool combinar_registro(const char *entrenador, void *registro, void *destino)
+{
+	registro_entrenador_t *origen = registro;
+	registro_entrenador_t *combinado = hash_obtener(destino, entrenador);
+	if (combinado == origen)
+		return true;
+	combinado->cantidad += origen->cantidad;
+	combinado->suma_salud += origen->suma_salud;
+	if (origen->salud_minima < combinado->salud_minima) {
+		combinado->salud_minima = origen->salud_minima;
+		combinado->con_salud_minima = origen->con_salud_minima;
+	} else if (origen->salud_minima == combinado->salud_minima) {
+		combinado->con_salud_minima += origen->con_salud_minima;
+	}
+	free(origen);
+	return true;
+}
+
+/*
+ * Segunda parte de la fusion, que no puede fallar: suma los registros de los
+ * entrenadores con pokemon en ambos hospitales y libera el hash del origen.
+ * Cuesta O(e), siendo e la cantidad de entrenadores del origen.
+ */
+void completar_fusion_estadisticas(hospital_t *destino, hospital_t *origen)
+{
+	hash_con_cada_clave(origen->estadisticas, combinar_registro,
+			    destino->estadisticas);
+	hash_destruir(origen->estadisticas);
+	origen->estadisticas = NULL;
+	destino->cantidad_entrenadores = hash_cantidad(destino->estadisticas);
+}
+
+/*
+ * Libera las estadisticas de los entrenadores.
+ */
+void destruir_estadisticas(hash_t *estadisticas)
+{
+	hash_destruir_todo(estadisticas, free);
+}
+
+/*
+ * Guarda en *estadisticas las estadisticas del entrenador: de las mantenidas
+ * por el hospital o, en una vista, recorriendo sus pokemon.
+ *
+ * Devuelve -1 en caso de error o si el entrenador no tiene pokemon, o 0 en
+ * caso de éxito.
+ */
+int hospital_estadisticas_entrenador(hospital_t *hospital,
+				     const char *entrenador,
+				     estadisticas_entrenador_t *estadisticas)
+{
+	if (!hospital || !entrenador || !estadisticas)
+		return ERROR;
+	registro_entrenador_t registro = { 0 };
+	bloquear_lectura(hospital);
+	if (hospital->vista) {
+		vista_a_cada_coincidencia(hospital->vista, coincide_entrenador,
+					  entrenador, sumar_pokemon_a_registro,
+					  &registro);
+	} else {
+		registro_entrenador_t *mantenido =
+			hash_obtener(hospital->estadisticas, entrenador);
+		if (mantenido)
+			registro = *mantenido;
+	}
+	desbloquear_lectura(hospital);
+	if (registro.cantidad == 0)
+		return ERROR;
+	estadisticas->cantidad = registro.cantidad;
+	estadisticas->salud_minima = registro.salud_minima;
+	estadisticas->salud_promedio =
+		(double)registro.suma_salud / (double)registro.cantidad;
+	return EXITO;
+}
+
+/**
+ * Funcion utilizada por hospital_cantidad_entrenadores() que agrega el
+ * entrenador del pokemon recorrido de una vista al hash de entrenadores.
+*/
+bool agregar_entrenador(pokemon_t *pokemon, void *entrenadores)
+{
+	return hash_insertar(entrenadores, pokemon->nombre_entrenador, NULL,
+			     NULL) != NULL;
+}
+
+/*
+ * Devuelve la cantidad de entrenadores distintos con pokemon en el hospital.
+ */
+size_t hospital_cantidad_entrenadores(hospital_t *hospital)
+{
+	if (!hospital)
+		return 0;
+	bloquear_lectura(hospital);
+	size_t cantidad = hospital->cantidad_entrenadores;
+	if (hospital->vista) {
+		hash_t *entrenadores = hash_crear(0);
+		size_t pokemones = vista_cantidad(hospital->vista);
+		cantidad = (entrenadores &&
+			    vista_a_cada_pokemon(hospital->vista, 0, pokemones,
+						 agregar_entrenador,
+						 entrenadores) == pokemones) ?
+				   hash_cantidad(entrenadores) :
+				   0;
+		hash_destruir(entrenadores);
+	}
+	desbloquear_lectura(hospital);
+	return cantidad;
+}
@@ -0,0 +1,213 @@
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define POKEMON_POR_BLOQUE 4096
+#define MAXIMO_INTENTOS 4
+
+/**
+ * Version inmutable de un hospital: una copia de sus pokemon en orden de
+ * prioridad, con la cantidad de referencias que la mantienen viva (la del
+ * hospital, mientras es su version actual, y la de cada lector).
+*/
+struct instantanea {
+	size_t referencias;
+	size_t cantidad;
+	pokemon_t pokemones[];
+};
+
+/**
+ * Funcion utilizada por copiar_hasta() que copia cada pokemon recorrido
+ * a la siguiente posicion de la instantanea.
+*/
+bool copiar_a_instantanea(pokemon_t *pokemon, void *instantanea)
+{
+	instantanea_t *version = instantanea;
+	version->pokemones[version->cantidad++] = *pokemon;
+	return true;
+}
+
+/**
+ * Reserva una instantanea vacia, con lugar para la cantidad indicada de
+ * pokemon y una referencia (la del hospital).
+ *
+ * Devuelve NULL en caso de error.
+*/
+instantanea_t *reservar_instantanea(size_t cantidad)
+{
+	if (cantidad > (SIZE_MAX - sizeof(instantanea_t)) / sizeof(pokemon_t))
+		return NULL;
+	instantanea_t *version =
+		malloc(sizeof(instantanea_t) + cantidad * sizeof(pokemon_t));
+	if (!version)
+		return NULL;
+	version->referencias = 1;
+	version->cantidad = 0;
+	return version;
+}
+
+/**
+ * Copia a la instantanea, a continuacion de los que ya tiene, los pokemon del
+ * hospital con prioridad menor a hasta.
+ *
+ * Devuelve false en caso de error.
+*/
+bool copiar_hasta(hospital_t *hospital, instantanea_t *version, size_t hasta)
+{
+	size_t desde = version->cantidad;
+	return a_cada_pokemon_entre_prioridades(hospital, desde, hasta,
+						copiar_a_instantanea,
+						version) == hasta - desde;
+}
+
+/**
+ * Devuelve la version actual del hospital con una referencia mas, o NULL si
+ * no hay una. Debe llamarse con el cerrojo tomado para leer.
+*/
+instantanea_t *tomar_version(hospital_t *hospital)
+{
+	bloquear_construccion(hospital);
+	instantanea_t *version = hospital->version;
+	if (version)
+		__atomic_add_fetch(&version->referencias, 1, __ATOMIC_RELAXED);
+	desbloquear_construccion(hospital);
+	return version;
+}
+
+/**
+ * Guarda la instantanea completa como version actual del hospital, salvo que
+ * otro lector ya haya guardado una del mismo estado: en ese caso la recibida
+ * se libera. Debe llamarse con el cerrojo tomado para leer.
+ *
+ * Devuelve la version actual con una referencia mas.
+*/
+instantanea_t *publicar_version(hospital_t *hospital, instantanea_t *nueva)
+{
+	bloquear_construccion(hospital);
+	if (!hospital->version) {
+		hospital->version = nueva;
+		nueva = NULL;
+	}
+	instantanea_t *version = hospital->version;
+	__atomic_add_fetch(&version->referencias, 1, __ATOMIC_RELAXED);
+	desbloquear_construccion(hospital);
+	free(nueva);
+	return version;
+}
+
+/*
+ * Devuelve la version actual del hospital, creandola si ninguna instantanea
+ * la capturo desde la ultima modificacion.
+ *
+ * La copia se hace de a POKEMON_POR_BLOQUE pokemon, soltando el cerrojo entre
+ * un bloque y el siguiente para que los escritores no esperen la copia
+ * entera. Si el hospital se modifica en el medio, la copia vuelve a empezar;
+ * el intento numero MAXIMO_INTENTOS copia todo sin soltar el cerrojo.
+ *
+ * Devuelve NULL en caso de error.
+ */
+instantanea_t *hospital_instantanea(hospital_t *hospital)
+{
+	if (!hospital)
+		return NULL;
+	bloquear_lectura(hospital);
+	instantanea_t *version = tomar_version(hospital);
+	instantanea_t *nueva = NULL;
+	size_t cantidad = 0, modificaciones = 0, intentos = 0;
+	while (!version) {
+		if (!nueva || hospital->modificaciones != modificaciones) {
+			free(nueva);
+			cantidad = cantidad_pokemones(hospital);
+			modificaciones = hospital->modificaciones;
+			intentos++;
+			nueva = reservar_instantanea(cantidad);
+			if (!nueva)
+				break;
+		}
+		size_t hasta = cantidad;
+		if (intentos < MAXIMO_INTENTOS &&
+		    cantidad - nueva->cantidad > POKEMON_POR_BLOQUE)
+			hasta = nueva->cantidad + POKEMON_POR_BLOQUE;
+		if (!copiar_hasta(hospital, nueva, hasta))
+			break;
+		if (nueva->cantidad == cantidad) {
+			version = publicar_version(hospital, nueva);
+			nueva = NULL;
+		} else {
+			desbloquear_lectura(hospital);
+			bloquear_lectura(hospital);
+			version = tomar_version(hospital);
+		}
+	}
+	desbloquear_lectura(hospital);
+	free(nueva);
+	return version;
+}
+
+/*
+ * Devuelve la cantidad de pokemon de la instantanea.
+ */
+size_t instantanea_cantidad(instantanea_t *instantanea)
+{
+	return (instantanea) ? instantanea->cantidad : 0;
+}
+
+/*
+ * Devuelve el pokemon de la instantanea con la prioridad indicada o NULL si
+ * no existe.
+ */
+pokemon_t *instantanea_obtener_pokemon(instantanea_t *instantanea,
+				       size_t prioridad)
+{
+	if (!instantanea || prioridad >= instantanea->cantidad)
+		return NULL;
+	return &instantanea->pokemones[prioridad];
+}
+
+/*
+ * Aplica la funcion a cada pokemon de la instantanea en orden de prioridad,
+ * hasta que devuelva false.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t instantanea_a_cada_pokemon(instantanea_t *instantanea,
+				  bool (*funcion)(pokemon_t *p, void *aux),
+				  void *aux)
+{
+	if (!instantanea || !funcion)
+		return 0;
+	size_t invocaciones = 0;
+	bool seguir = true;
+	while (seguir && invocaciones < instantanea->cantidad)
+		seguir = funcion(&instantanea->pokemones[invocaciones++], aux);
+	return invocaciones;
+}
+
+/*
+ * Suelta una referencia a la instantanea, liberandola si era la ultima.
+ */
+void instantanea_liberar(instantanea_t *instantanea)
+{
+	if (!instantanea)
+		return;
+	if (__atomic_sub_fetch(&instantanea->referencias, 1,
+			       __ATOMIC_ACQ_REL) == 0)
+		free(instantanea);
+}
+
+/*
+ * Descarta la version actual del hospital, porque va a modificarse, y cuenta
+ * la modificacion. Las instantaneas que la capturaron la conservan hasta
+ * liberarla.
+ */
+void descartar_version(hospital_t *hospital)
+{
+	hospital->modificaciones++;
+	if (!hospital->version)
+		return;
+	instantanea_liberar(hospital->version);
+	hospital->version = NULL;
+}
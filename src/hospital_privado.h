@@ -0,0 +1,277 @@
+#ifndef HOSPITAL_PRIVADO_H_
+#define HOSPITAL_PRIVADO_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tp1.h"
+#include "hospital.h"
+#include "pokemon_privado.h"
+#include "heap.h"
+#include "abb.h"
+#include "hash.h"
+#include "arena.h"
+
+// Este archivo es privado de la implementación: lo comparten los archivos de
+// src/ que implementan las operaciones del hospital, pero el usuario no lo
+// conoce.
+
+// Los pokemon del hospital se almacenan en un heap minimal ordenado por
+// prioridad, de forma que el pokemon con menos salud (el de mayor prioridad)
+// siempre se encuentra en la raiz.
+//
+// Ademas se mantiene un arbol AVL con los mismos pokemon y el mismo orden,
+// aumentado con el tamaño de cada subarbol. El arbol permite recorrer el
+// hospital en orden sin ordenar nada y obtener un pokemon por prioridad (o la
+// prioridad de un pokemon) en O(log n).
+//
+// El heap avisa la posicion de cada pokemon, que se guarda en el propio
+// pokemon, para poder reubicarlo cuando cambia su salud sin buscarlo.
+//
+// Los indices por id, por nombre y por entrenador (cada uno con la lista de
+// pokemon con esa clave) se construyen recien la primera vez que se
+// consultan, y desde entonces se mantienen al ingresar y atender pokemon.
+//
+// Las consultas sobre la distribucion de saludes (percentiles, cantidad con
+// salud menor a un valor, maxima) se resuelven con el arbol en O(log n); la
+// suma de las saludes de todo el hospital se mantiene al ingresar, atender y
+// cambiar la salud de cada pokemon para calcular el promedio en O(1).
+//
+// Las estadisticas de cada entrenador (cantidad de pokemon, suma de saludes
+// y salud minima) se guardan en un hash por nombre de entrenador, y se
+// actualizan en O(1) al ingresar cada pokemon. Al atender un pokemon o
+// cambiar su salud tambien cuestan O(1), salvo si era el ultimo con la salud
+// minima de su entrenador: entonces se recorren los pokemon del entrenador
+// con el indice por entrenador.
+//
+// Los pokemon leidos del archivo viven en una arena propia del hospital, que
+// se libera de una sola vez. Los que llegan en ambulancia se reservaron por
+// fuera del hospital y se liberan de a uno.
+//
+// Un hospital abierto con hospital_abrir_mmap() no usa ninguna de esas
+// estructuras: todas las operaciones se resuelven sobre su vista.
+//
+// Si el hospital tiene un diario abierto con hospital_abrir_diario(), cada
+// lote de emergencias se registra en el diario despues de ingresar completo
+// (si el registro falla, el lote se deshace), y cada atencion o cambio de
+// salud antes de aplicarse.
+//
+// Si se habilito la concurrencia con hospital_habilitar_concurrencia(), las
+// operaciones publicas toman el cerrojo del hospital: las que solo leen lo
+// comparten y las que modifican el hospital lo toman en exclusiva. Las
+// operaciones internas (las de este archivo y las que llaman las funciones
+// publicas) nunca toman el cerrojo, para no tomarlo dos veces.
+//
+// La ultima instantanea creada con hospital_instantanea() queda guardada como
+// version actual del hospital, y se comparte con las siguientes hasta que el
+// hospital se modifica: entonces el hospital suelta su referencia y la
+// proxima instantanea copia una version nueva. Cada modificacion tambien
+// incrementa modificaciones, con el que la copia (que se hace de a bloques,
+// soltando el cerrojo entre uno y otro) detecta que tiene que empezar de
+// nuevo.
+
+// Vista de un archivo mapeado, diario y cerrojo de un hospital, cada uno
+// implementado en su propio archivo de src/.
+typedef struct vista_hospital vista_hospital_t;
+typedef struct diario diario_t;
+typedef struct cerrojo_hospital cerrojo_hospital_t;
+
+struct _hospital_pkm_t {
+	vista_hospital_t *vista;
+	diario_t *diario;
+	cerrojo_hospital_t *cerrojo;
+	instantanea_t *version;
+	size_t modificaciones;
+	heap_t *pokemones;
+	abb_t *prioridades;
+	hash_t *indice_id;
+	hash_t *indice_nombre;
+	hash_t *indice_entrenador;
+	hash_t *estadisticas;
+	arena_t *registros;
+	size_t proximo_ingreso;
+	size_t cantidad_entrenadores;
+	size_t suma_salud;
+};
+
+// Comparador del heap y del arbol de pokemones: tiene mas prioridad el
+// pokemon con menos salud y, a igual salud, el que ingreso antes.
+int comparar_prioridad_pokemones(void *pokemon1, void *pokemon2);
+
+// Crea un hospital a partir de un vector de pokemones ya ordenado por
+// prioridad (que puede estar vacio). Si se crea, el hospital pasa a ser dueño
+// de la arena donde estan los pokemon del vector (pero no del vector).
+// Devuelve NULL en caso de error.
+hospital_t *hospital_crear(pokemon_t **ordenados, size_t cantidad,
+			   arena_t *registros);
+
+// Ingresa un pokemon al hospital con el siguiente numero de ingreso, sin
+// registrarlo en el diario. Devuelve false en caso de error.
+bool ingresar_pokemon(hospital_t *hospital, pokemon_t *pokemon);
+
+// Ordena el vector de pokemones por prioridad segun su salud, de forma
+// estable (a igual salud se conserva el orden del vector). Devuelve false en
+// caso de error.
+bool ordenar_carga_por_prioridad(pokemon_t **pokemones, size_t cantidad);
+
+// Devuelve el tamaño del archivo abierto en el descriptor, o 0 si no es un
+// archivo regular y por lo tanto no se conoce.
+size_t tamanio_archivo(int descriptor);
+
+// Ordena por prioridad los indices de un vector de saludes (de forma estable,
+// como ordenar_carga_por_prioridad()). Devuelve la permutacion obtenida, que
+// debe liberarse con free, o NULL en caso de error.
+size_t *ordenar_saludes_por_prioridad(size_t *saludes, size_t cantidad);
+
+// Formato de los archivos de hospital_guardar_binario(): un encabezado seguido
+// de cantidad registros de tamanio_registro bytes, cada uno con la
+// representacion en memoria de un pokemon_t (con el relleno en cero).
+//
+// Si esta la bandera BANDERA_ORDENADO, los registros estan ordenados por
+// prioridad y conservan su orden de ingreso. Si no, el orden de los registros
+// se toma como orden de ingreso y se ordenan al cargarlos.
+#define FIRMA_BINARIO "HOSPKM"
+#define LARGO_FIRMA_BINARIO 8
+#define VERSION_BINARIO 2
+#define BANDERA_ORDENADO 1u
+#define SUMA_INICIAL 14695981039346656037ull
+
+typedef struct encabezado_binario {
+	char firma[LARGO_FIRMA_BINARIO];
+	uint32_t version;
+	uint32_t banderas;
+	uint64_t cantidad;
+	uint64_t tamanio_registro;
+	uint64_t suma_verificacion;
+} encabezado_binario_t;
+
+// Valida el encabezado de un archivo binario del tamaño indicado (contando el
+// encabezado). Devuelve false si el encabezado no es valido.
+bool validar_encabezado_binario(const encabezado_binario_t *encabezado,
+				uint64_t tamanio);
+
+// Acumula en la suma los registros recibidos y devuelve la suma actualizada.
+// Las sumas de un archivo empiezan en SUMA_INICIAL.
+uint64_t sumar_registros(uint64_t suma, const pokemon_t *registros,
+			 size_t cantidad);
+
+// Copia el pokemon a un registro binario, con el relleno en cero.
+void copiar_registro_binario(pokemon_t *registro, const pokemon_t *original);
+
+// Devuelve true si los nombres del registro binario estan terminados en '\0'.
+bool registro_binario_valido(const pokemon_t *registro);
+
+// Operaciones del hospital sobre una vista de un archivo mapeado en memoria.
+size_t vista_cantidad(vista_hospital_t *vista);
+pokemon_t *vista_obtener_pokemon(vista_hospital_t *vista, size_t prioridad);
+size_t vista_a_cada_pokemon(vista_hospital_t *vista, size_t desde,
+			    size_t hasta,
+			    bool (*funcion)(pokemon_t *p, void *aux),
+			    void *aux);
+bool vista_buscar_primero(vista_hospital_t *vista,
+			  bool (*coincide)(const pokemon_t *pokemon,
+					   const void *criterio),
+			  const void *criterio, size_t *prioridad);
+size_t vista_a_cada_coincidencia(vista_hospital_t *vista,
+				 bool (*coincide)(const pokemon_t *pokemon,
+						  const void *criterio),
+				 const void *criterio,
+				 bool (*funcion)(pokemon_t *p, void *aux),
+				 void *aux);
+size_t vista_cantidad_salud_menor(vista_hospital_t *vista, size_t salud);
+void vista_destruir(vista_hospital_t *vista);
+
+// Tipos de lote del diario: pokemon que ingresan al hospital, pokemon
+// atendidos (en orden de prioridad) y pokemon con su nueva salud.
+#define LOTE_EMERGENCIAS 0
+#define LOTE_ATENCION 1
+#define LOTE_ACTUALIZACION 2
+
+// Agrega al diario un lote del tipo indicado con los pokemon recibidos, antes
+// de aplicarlo al hospital (o despues de ingresarlo, si es de emergencias), y
+// lo sincroniza con el disco segun la politica del diario. Devuelve false en
+// caso de error.
+bool diario_registrar_lote(diario_t *diario, uint32_t tipo,
+			   pokemon_t **pokemones, size_t cantidad);
+
+// Detiene el hilo sincronizador (si lo hay), sincroniza segun la politica y
+// cierra el diario.
+void diario_cerrar(diario_t *diario);
+
+// Igual que hospital_cantidad_pokemones() y hospital_a_cada_pokemon(), sin
+// tomar el cerrojo.
+size_t cantidad_pokemones(hospital_t *hospital);
+size_t a_cada_pokemon(hospital_t *hospital,
+		      bool (*funcion)(pokemon_t *p, void *aux), void *aux);
+
+// Igual que a_cada_pokemon(), pero solo con los pokemon con prioridad en
+// [desde, hasta).
+size_t a_cada_pokemon_entre_prioridades(hospital_t *hospital, size_t desde,
+					size_t hasta,
+					bool (*funcion)(pokemon_t *p,
+							void *aux),
+					void *aux);
+
+// Ingresa los pokemon al hospital igual que hospital_aceptar_emergencias(),
+// sin tomar el cerrojo, y guarda en *ingresados (si no es NULL) cuantos
+// ingresaron: todos o ninguno, ya que si el lote no ingresa completo (o no
+// puede registrarse en el diario) se deshace. Devuelve -1 en caso de error o
+// 0 en caso de exito.
+int aceptar_emergencias(hospital_t *hospital, pokemon_t **pokemones,
+			size_t cantidad, size_t *ingresados);
+
+// Toman y sueltan el cerrojo del hospital para leer o para escribir. No hacen
+// nada si el hospital no es concurrente.
+void bloquear_lectura(hospital_t *hospital);
+void desbloquear_lectura(hospital_t *hospital);
+void bloquear_escritura(hospital_t *hospital);
+void desbloquear_escritura(hospital_t *hospital);
+
+// Toman y sueltan el mutex que ordena la construccion de los indices cuando
+// varios lectores los consultan a la vez.
+void bloquear_construccion(hospital_t *hospital);
+void desbloquear_construccion(hospital_t *hospital);
+
+// Libera el cerrojo de un hospital concurrente.
+void cerrojo_destruir(cerrojo_hospital_t *cerrojo);
+
+// Suelta la version actual del hospital (si hay una) y cuenta la
+// modificacion, antes de modificarlo.
+void descartar_version(hospital_t *hospital);
+
+// Devuelve el indice guardado en *indice, construyendolo con la funcion
+// recibida si todavia no existe, o NULL en caso de error.
+hash_t *obtener_indice(hospital_t *hospital, hash_t **indice,
+		       bool (*indexar)(hash_t *indice, pokemon_t *pokemon));
+
+// Agrega el pokemon al indice por entrenador. Devuelve false en caso de
+// error.
+bool indexar_entrenador(hash_t *indice, pokemon_t *pokemon);
+
+// Criterio de busqueda de la vista: devuelve true si el pokemon es del
+// entrenador indicado.
+bool coincide_entrenador(const pokemon_t *pokemon, const void *entrenador);
+
+// Mantienen las estadisticas por entrenador del hospital: suman un pokemon
+// que ingresa (devuelve false en caso de error), restan uno que ya salio del
+// hospital y de sus indices, y actualizan las de un pokemon que cambio su
+// salud.
+bool sumar_a_entrenador(hospital_t *hospital, pokemon_t *pokemon);
+void restar_de_entrenador(hospital_t *hospital, const char *entrenador,
+			  size_t salud);
+void cambiar_salud_de_entrenador(hospital_t *hospital,
+				 const pokemon_t *pokemon,
+				 size_t salud_anterior);
+void destruir_estadisticas(hash_t *estadisticas);
+
+// Fusionan las estadisticas del origen en las del destino en dos partes: la
+// primera mueve los registros de los entrenadores nuevos para el destino y es
+// la unica que puede fallar (devuelve false y deja todo como estaba, o se
+// deshace despues con deshacer_fusion_estadisticas()); la segunda combina el
+// resto y libera las estadisticas del origen.
+bool preparar_fusion_estadisticas(hospital_t *destino, hospital_t *origen);
+void deshacer_fusion_estadisticas(hospital_t *destino, hospital_t *origen);
+void completar_fusion_estadisticas(hospital_t *destino, hospital_t *origen);
+
+#endif // HOSPITAL_PRIVADO_H_
@@ -0,0 +1,462 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define LARGO_COPIA_LINEA 128
+#define LARGO_ESTIMADO_LINEA_VISTA 24
+#define POKEMON_POR_PAGINA_VISTA 1024
+
+/**
+ * Vista de un archivo de hospital mapeado en memoria. El archivo no se copia:
+ * solo se guarda, en orden de prioridad, donde esta cada pokemon.
+ *
+ * Para un CSV, indice tiene el desplazamiento de la linea de cada pokemon.
+ * Los recorridos arman cada pokemon en un registro auxiliar que reutilizan, y
+ * solo los pokemon que se piden de a uno (con vista_obtener_pokemon()) se
+ * arman en la arena materializados, recordados en paginas para devolver
+ * siempre el mismo puntero.
+ *
+ * Para un archivo binario, los registros mapeados ya son pokemon_t y se
+ * devuelven directamente. Si los registros no estaban ordenados, indice tiene
+ * el numero de registro de cada prioridad; si lo estaban, indice es NULL.
+*/
+struct vista_hospital {
+	char *mapa;
+	size_t tamanio;
+	pokemon_t *registros;
+	size_t *indice;
+	size_t cantidad;
+	pokemon_t ***paginas;
+	arena_t *materializados;
+};
+
+/**
+ * Lee un pokemon de una linea del archivo mapeado (que no esta terminada en
+ * '\0' y no se puede modificar). La linea se copia a un buffer local, o a uno
+ * reservado si es demasiado larga.
+ *
+ * Devuelve false si la linea es invalida o en caso de error.
+*/
+bool leer_linea_mapeada(const char *linea, size_t largo, pokemon_t *pokemon)
+{
+	char copia_local[LARGO_COPIA_LINEA];
+	char *copia = (largo < LARGO_COPIA_LINEA) ? copia_local :
+						    malloc(largo + 1);
+	if (!copia)
+		return false;
+	memcpy(copia, linea, largo);
+	copia[largo] = '\0';
+	bool exito = pokemon_leer_desde_string(pokemon, copia);
+	if (copia != copia_local)
+		free(copia);
+	return exito;
+}
+
+/**
+ * Devuelve el largo de la linea que empieza en el desplazamiento indicado,
+ * sin contar el salto de linea.
+*/
+size_t largo_linea_mapeada(vista_hospital_t *vista, size_t desplazamiento)
+{
+	const char *linea = vista->mapa + desplazamiento;
+	const char *fin_linea =
+		memchr(linea, '\n', vista->tamanio - desplazamiento);
+	return (fin_linea) ? (size_t)(fin_linea - linea) :
+			     vista->tamanio - desplazamiento;
+}
+
+/**
+ * Recorre una vez el CSV mapeado validando cada linea, y guarda la salud de
+ * cada pokemon en un vector (en el orden del archivo) del que se reserva uno
+ * mas grande si se llena. Las lineas vacias se ignoran.
+ *
+ * Devuelve el vector de saludes (del tamaño justo) o NULL si no hay ningun
+ * pokemon, si alguna linea es invalida o en caso de error.
+*/
+size_t *leer_saludes_csv(vista_hospital_t *vista)
+{
+	size_t capacidad = vista->tamanio / LARGO_ESTIMADO_LINEA_VISTA + 1;
+	size_t *saludes = malloc(sizeof(size_t) * capacidad);
+	bool exito = saludes != NULL;
+	posix_madvise(vista->mapa, vista->tamanio, POSIX_MADV_SEQUENTIAL);
+	size_t desplazamiento = 0;
+	while (exito && desplazamiento < vista->tamanio) {
+		size_t largo = largo_linea_mapeada(vista, desplazamiento);
+		pokemon_t pokemon;
+		if (largo > 0 && vista->cantidad == capacidad) {
+			size_t *nuevas = realloc(saludes, sizeof(size_t) *
+								  capacidad * 2);
+			exito = nuevas != NULL;
+			if (exito) {
+				saludes = nuevas;
+				capacidad *= 2;
+			}
+		}
+		if (exito && largo > 0) {
+			exito = leer_linea_mapeada(vista->mapa + desplazamiento,
+						   largo, &pokemon);
+			if (exito)
+				saludes[vista->cantidad++] = pokemon.salud;
+		}
+		desplazamiento += largo + 1;
+	}
+	posix_madvise(vista->mapa, vista->tamanio, POSIX_MADV_NORMAL);
+	if (!exito || vista->cantidad == 0) {
+		free(saludes);
+		return NULL;
+	}
+	// Se devuelve la memoria que sobro de la estimacion o del ultimo
+	// crecimiento, antes de ordenar.
+	size_t *ajustadas =
+		realloc(saludes, sizeof(size_t) * vista->cantidad);
+	return (ajustadas) ? ajustadas : saludes;
+}
+
+/**
+ * Arma el indice de desplazamientos del CSV mapeado en orden de prioridad.
+ *
+ * Para no tener a la vez los desplazamientos, las saludes y la permutacion,
+ * primero se ordenan las saludes (leidas en una primera pasada) y recien
+ * despues, liberadas las saludes, una segunda pasada (que solo busca los
+ * saltos de linea) anota los desplazamientos. Asi la memoria que se usa al
+ * abrir el archivo no supera los 24 bytes por pokemon, y despues solo queda
+ * el indice, de 8 bytes por pokemon.
+ *
+ * Devuelve false si alguna linea es invalida o en caso de error.
+*/
+bool indexar_csv(vista_hospital_t *vista)
+{
+	size_t *saludes = leer_saludes_csv(vista);
+	size_t *permutacion = NULL;
+	if (saludes)
+		permutacion =
+			ordenar_saludes_por_prioridad(saludes, vista->cantidad);
+	free(saludes);
+	size_t *desplazamientos =
+		(permutacion) ? malloc(sizeof(size_t) * vista->cantidad) : NULL;
+	if (!desplazamientos) {
+		free(permutacion);
+		return false;
+	}
+	size_t linea = 0, desplazamiento = 0;
+	while (desplazamiento < vista->tamanio) {
+		size_t largo = largo_linea_mapeada(vista, desplazamiento);
+		if (largo > 0)
+			desplazamientos[linea++] = desplazamiento;
+		desplazamiento += largo + 1;
+	}
+	// La permutacion ya no se necesita: se reemplaza en el lugar por los
+	// desplazamientos que indica, y queda como indice de la vista.
+	for (size_t i = 0; i < vista->cantidad; i++)
+		permutacion[i] = desplazamientos[permutacion[i]];
+	free(desplazamientos);
+	vista->indice = permutacion;
+
+	vista->paginas = calloc(vista->cantidad / POKEMON_POR_PAGINA_VISTA + 1,
+				sizeof(pokemon_t **));
+	vista->materializados = arena_crear(sizeof(pokemon_t), 0);
+	return vista->paginas && vista->materializados;
+}
+
+/**
+ * Devuelve true si los registros del archivo binario mapeado respetan el
+ * orden de prioridad, como verifica hospital_cargar_binario() al cargarlos.
+*/
+bool registros_en_orden(vista_hospital_t *vista)
+{
+	for (size_t i = 1; i < vista->cantidad; i++)
+		if (comparar_prioridad_pokemones(&vista->registros[i - 1],
+						 &vista->registros[i]) >= 0)
+			return false;
+	return true;
+}
+
+/**
+ * Prepara la vista de un archivo binario mapeado. Si los registros no estan
+ * ordenados arma el indice de prioridades a partir de sus saludes. Si el
+ * archivo dice estar ordenado se verifica en O(n), ya que las consultas
+ * buscan en los registros confiando en ese orden.
+ *
+ * Devuelve false si el archivo no es valido o en caso de error.
+*/
+bool indexar_binario(vista_hospital_t *vista)
+{
+	encabezado_binario_t encabezado;
+	memcpy(&encabezado, vista->mapa, sizeof(encabezado));
+	if (!validar_encabezado_binario(&encabezado, vista->tamanio))
+		return false;
+	vista->cantidad = (size_t)encabezado.cantidad;
+	vista->registros = (pokemon_t *)(vista->mapa + sizeof(encabezado));
+	if (encabezado.banderas & BANDERA_ORDENADO)
+		return registros_en_orden(vista);
+
+	size_t *saludes = malloc(sizeof(size_t) * vista->cantidad);
+	if (!saludes)
+		return false;
+	for (size_t i = 0; i < vista->cantidad; i++)
+		saludes[i] = vista->registros[i].salud;
+	vista->indice = ordenar_saludes_por_prioridad(saludes, vista->cantidad);
+	free(saludes);
+	return vista->indice != NULL;
+}
+
+/**
+ * Devuelve true si el archivo mapeado empieza con la firma de los archivos
+ * binarios de hospital_guardar_binario().
+*/
+bool vista_es_binaria(vista_hospital_t *vista)
+{
+	return vista->tamanio >= sizeof(encabezado_binario_t) &&
+	       memcmp(vista->mapa, FIRMA_BINARIO, sizeof(FIRMA_BINARIO)) == 0;
+}
+
+/*
+ * Abre un archivo de hospital (CSV o binario) mapeandolo en memoria, sin
+ * copiar sus registros.
+ *
+ * Devuelve NULL si el archivo es invalido o en caso de error.
+ */
+hospital_t *hospital_abrir_mmap(const char *nombre_archivo)
+{
+	if (!nombre_archivo)
+		return NULL;
+	int descriptor = open(nombre_archivo, O_RDONLY);
+	if (descriptor < 0)
+		return NULL;
+	size_t tamanio = tamanio_archivo(descriptor);
+	void *mapa = (tamanio > 0) ? mmap(NULL, tamanio, PROT_READ,
+					  MAP_PRIVATE, descriptor, 0) :
+				     MAP_FAILED;
+	close(descriptor);
+	if (mapa == MAP_FAILED)
+		return NULL;
+
+	hospital_t *hospital = calloc(1, sizeof(hospital_t));
+	vista_hospital_t *vista = calloc(1, sizeof(vista_hospital_t));
+	if (!hospital || !vista) {
+		free(hospital);
+		free(vista);
+		munmap(mapa, tamanio);
+		return NULL;
+	}
+	vista->mapa = mapa;
+	vista->tamanio = tamanio;
+	bool exito = (vista_es_binaria(vista)) ? indexar_binario(vista) :
+						 indexar_csv(vista);
+	if (!exito) {
+		vista_destruir(vista);
+		free(hospital);
+		return NULL;
+	}
+	hospital->vista = vista;
+	return hospital;
+}
+
+/*
+ * Devuelve la cantidad de pokemon de la vista.
+ */
+size_t vista_cantidad(vista_hospital_t *vista)
+{
+	return vista->cantidad;
+}
+
+/**
+ * Devuelve el pokemon con la prioridad indicada sin materializarlo: para un
+ * archivo binario, el registro mapeado; para un CSV, el pokemon leido en
+ * *auxiliar. En ambos casos el orden de ingreso queda en *ingreso.
+ *
+ * Devuelve NULL si el registro es invalido o en caso de error.
+*/
+const pokemon_t *vista_consultar(vista_hospital_t *vista, size_t prioridad,
+				 pokemon_t *auxiliar, size_t *ingreso)
+{
+	if (vista->registros) {
+		size_t numero = (vista->indice) ? vista->indice[prioridad] :
+						  prioridad;
+		const pokemon_t *registro = &vista->registros[numero];
+		*ingreso = (vista->indice) ? numero : registro->ingreso;
+		return (registro_binario_valido(registro)) ? registro : NULL;
+	}
+	size_t desplazamiento = vista->indice[prioridad];
+	*ingreso = desplazamiento;
+	if (!leer_linea_mapeada(vista->mapa + desplazamiento,
+				largo_linea_mapeada(vista, desplazamiento),
+				auxiliar))
+		return NULL;
+	auxiliar->ingreso = desplazamiento;
+	return auxiliar;
+}
+
+/*
+ * Devuelve el pokemon con la prioridad indicada, materializandolo si es la
+ * primera vez que se lo pide.
+ */
+pokemon_t *vista_obtener_pokemon(vista_hospital_t *vista, size_t prioridad)
+{
+	size_t ingreso;
+	if (vista->registros)
+		return (pokemon_t *)vista_consultar(vista, prioridad, NULL,
+						    &ingreso);
+
+	pokemon_t ***pagina = &vista->paginas[prioridad /
+					       POKEMON_POR_PAGINA_VISTA];
+	if (!*pagina) {
+		*pagina = calloc(POKEMON_POR_PAGINA_VISTA, sizeof(pokemon_t *));
+		if (!*pagina)
+			return NULL;
+	}
+	pokemon_t **materializado =
+		&(*pagina)[prioridad % POKEMON_POR_PAGINA_VISTA];
+	if (*materializado)
+		return *materializado;
+	pokemon_t *pokemon = arena_reservar(vista->materializados);
+	if (!pokemon)
+		return NULL;
+	if (!vista_consultar(vista, prioridad, pokemon, &ingreso)) {
+		arena_liberar(vista->materializados, pokemon);
+		return NULL;
+	}
+	*materializado = pokemon;
+	return pokemon;
+}
+
+/*
+ * Aplica la funcion a cada pokemon de la vista con prioridad en
+ * [desde, hasta), en orden de prioridad. Los pokemon de un CSV se arman en un
+ * registro auxiliar, que solo es valido durante cada llamada a la funcion.
+ */
+size_t vista_a_cada_pokemon(vista_hospital_t *vista, size_t desde,
+			    size_t hasta,
+			    bool (*funcion)(pokemon_t *p, void *aux),
+			    void *aux)
+{
+	size_t invocaciones = 0;
+	for (size_t i = desde; i < hasta && i < vista->cantidad; i++) {
+		pokemon_t auxiliar;
+		size_t ingreso;
+		const pokemon_t *pokemon =
+			vista_consultar(vista, i, &auxiliar, &ingreso);
+		if (!pokemon)
+			break;
+		invocaciones++;
+		if (!funcion((pokemon_t *)pokemon, aux))
+			break;
+	}
+	return invocaciones;
+}
+
+/**
+ * Devuelve la salud del pokemon con la prioridad indicada sin materializarlo,
+ * o SIZE_MAX si no se puede leer.
+*/
+size_t vista_salud(vista_hospital_t *vista, size_t prioridad)
+{
+	pokemon_t auxiliar;
+	size_t ingreso;
+	if (vista->registros)
+		return vista->registros[(vista->indice) ?
+						vista->indice[prioridad] :
+						prioridad]
+			.salud;
+	const pokemon_t *pokemon =
+		vista_consultar(vista, prioridad, &auxiliar, &ingreso);
+	return (pokemon) ? pokemon->salud : SIZE_MAX;
+}
+
+/*
+ * Devuelve la cantidad de pokemon de la vista con salud menor a la indicada,
+ * con una busqueda binaria sobre el indice (que esta ordenado por salud).
+ */
+size_t vista_cantidad_salud_menor(vista_hospital_t *vista, size_t salud)
+{
+	size_t inicio = 0, fin = vista->cantidad;
+	while (inicio < fin) {
+		size_t medio = inicio + (fin - inicio) / 2;
+		if (vista_salud(vista, medio) < salud)
+			inicio = medio + 1;
+		else
+			fin = medio;
+	}
+	return inicio;
+}
+
+/*
+ * Busca el primer pokemon (el que ingreso primero) que cumple el criterio,
+ * recorriendo la vista sin materializar ningun pokemon.
+ */
+bool vista_buscar_primero(vista_hospital_t *vista,
+			  bool (*coincide)(const pokemon_t *pokemon,
+					   const void *criterio),
+			  const void *criterio, size_t *prioridad)
+{
+	bool encontrado = false;
+	size_t primer_ingreso = 0;
+	for (size_t i = 0; i < vista->cantidad; i++) {
+		pokemon_t auxiliar;
+		size_t ingreso;
+		const pokemon_t *pokemon =
+			vista_consultar(vista, i, &auxiliar, &ingreso);
+		if (!pokemon || !coincide(pokemon, criterio) ||
+		    (encontrado && ingreso >= primer_ingreso))
+			continue;
+		encontrado = true;
+		primer_ingreso = ingreso;
+		*prioridad = i;
+	}
+	return encontrado;
+}
+
+/*
+ * Aplica la funcion a cada pokemon de la vista que cumple el criterio, en
+ * orden de prioridad. Como en vista_a_cada_pokemon(), ningun pokemon se
+ * materializa.
+ */
+size_t vista_a_cada_coincidencia(vista_hospital_t *vista,
+				 bool (*coincide)(const pokemon_t *pokemon,
+						  const void *criterio),
+				 const void *criterio,
+				 bool (*funcion)(pokemon_t *p, void *aux),
+				 void *aux)
+{
+	size_t invocaciones = 0;
+	for (size_t i = 0; i < vista->cantidad; i++) {
+		pokemon_t auxiliar;
+		size_t ingreso;
+		const pokemon_t *pokemon =
+			vista_consultar(vista, i, &auxiliar, &ingreso);
+		if (!pokemon || !coincide(pokemon, criterio))
+			continue;
+		invocaciones++;
+		if (!funcion((pokemon_t *)pokemon, aux))
+			break;
+	}
+	return invocaciones;
+}
+
+/*
+ * Libera la vista: el indice, los pokemon materializados y el mapeo del
+ * archivo.
+ */
+void vista_destruir(vista_hospital_t *vista)
+{
+	if (!vista)
+		return;
+	if (vista->paginas)
+		for (size_t i = 0;
+		     i <= vista->cantidad / POKEMON_POR_PAGINA_VISTA; i++)
+			free(vista->paginas[i]);
+	free(vista->paginas);
+	free(vista->indice);
+	arena_destruir(vista->materializados);
+	munmap(vista->mapa, vista->tamanio);
+	free(vista);
+}
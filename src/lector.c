@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lector.h"
+
+#define TAMANIO_BLOQUE_LECTOR 65536
+
+/**
+ * Estructura principal del lector. El buffer contiene los bytes leidos y
+ * todavia no entregados en [inicio, fin); revisado indica hasta donde ya se
+ * busco un salto de linea, para no volver a recorrer esos bytes cuando una
+ * linea ocupa varios bloques.
+*/
+struct lector {
+	int descriptor;
+	bool propio;
+	char *buffer;
+	size_t capacidad;
+	size_t inicio;
+	size_t revisado;
+	size_t fin;
+	size_t largo_maximo;
+	bool fin_de_entrada;
+	bool error;
+	bool linea_larga;
+};
+
+/*
+ * Crea un lector de lineas sobre el descriptor de archivo recibido.
+ *
+ * Devuelve un puntero al lector creado o NULL en caso de error.
+ */
+lector_t *lector_crear(int descriptor, size_t largo_maximo)
+{
+	if (descriptor < 0 || largo_maximo == 0)
+		return NULL;
+	lector_t *lector_creado = calloc(1, sizeof(lector_t));
+	if (!lector_creado)
+		return NULL;
+	lector_creado->buffer = malloc(TAMANIO_BLOQUE_LECTOR);
+	if (!lector_creado->buffer) {
+		free(lector_creado);
+		return NULL;
+	}
+	lector_creado->capacidad = TAMANIO_BLOQUE_LECTOR;
+	lector_creado->descriptor = descriptor;
+	lector_creado->largo_maximo = largo_maximo;
+	return lector_creado;
+}
+
+/*
+ * Abre el archivo indicado y crea un lector sobre el.
+ *
+ * Devuelve un puntero al lector creado o NULL en caso de error.
+ */
+lector_t *lector_abrir(const char *ruta, size_t largo_maximo)
+{
+	if (!ruta)
+		return NULL;
+	int descriptor = open(ruta, O_RDONLY);
+	if (descriptor < 0)
+		return NULL;
+	lector_t *lector_creado = lector_crear(descriptor, largo_maximo);
+	if (!lector_creado) {
+		close(descriptor);
+		return NULL;
+	}
+	lector_creado->propio = true;
+	return lector_creado;
+}
+
+/**
+ * Lee un nuevo bloque del descriptor al final del buffer. Antes mueve la
+ * linea actual al principio del buffer y, si no queda lugar, lo duplica.
+ *
+ * Devuelve false si no se leyo nada, por fin de entrada o por error.
+*/
+bool lector_cargar_bloque(lector_t *lector)
+{
+	if (lector->fin_de_entrada)
+		return false;
+	if (lector->inicio > 0) {
+		memmove(lector->buffer, lector->buffer + lector->inicio,
+			lector->fin - lector->inicio);
+		lector->fin -= lector->inicio;
+		lector->revisado -= lector->inicio;
+		lector->inicio = 0;
+	}
+	if (lector->fin == lector->capacidad - 1) {
+		char *nuevo_buffer =
+			realloc(lector->buffer, lector->capacidad * 2);
+		if (!nuevo_buffer) {
+			lector->error = true;
+			return false;
+		}
+		lector->buffer = nuevo_buffer;
+		lector->capacidad *= 2;
+	}
+	ssize_t leidos;
+	do {
+		leidos = read(lector->descriptor, lector->buffer + lector->fin,
+			      lector->capacidad - 1 - lector->fin);
+	} while (leidos < 0 && errno == EINTR);
+	if (leidos < 0) {
+		lector->error = true;
+		return false;
+	}
+	if (leidos == 0) {
+		lector->fin_de_entrada = true;
+		return false;
+	}
+	lector->fin += (size_t)leidos;
+	return true;
+}
+
+/*
+ * Devuelve la siguiente linea, sin el salto de linea y terminada en '\0', o
+ * NULL al final de la entrada o en caso de error.
+ */
+char *lector_leer_linea(lector_t *lector, size_t *largo)
+{
+	if (!lector)
+		return NULL;
+	lector->error = false;
+	lector->linea_larga = false;
+	bool descartando = false;
+	while (true) {
+		char *salto = memchr(lector->buffer + lector->revisado, '\n',
+				     lector->fin - lector->revisado);
+		if (salto) {
+			char *linea = lector->buffer + lector->inicio;
+			size_t largo_linea = (size_t)(salto - linea);
+			lector->inicio = lector->revisado =
+				(size_t)(salto - lector->buffer) + 1;
+			if (descartando || largo_linea > lector->largo_maximo) {
+				lector->error = true;
+				lector->linea_larga = true;
+				return NULL;
+			}
+			*salto = '\0';
+			if (largo)
+				*largo = largo_linea;
+			return linea;
+		}
+		lector->revisado = lector->fin;
+		if (lector->fin - lector->inicio > lector->largo_maximo) {
+			descartando = true;
+			lector->inicio = lector->revisado = lector->fin;
+		}
+		if (!lector_cargar_bloque(lector))
+			break;
+	}
+
+	if (lector->error || descartando) {
+		lector->linea_larga = !lector->error;
+		lector->error = true;
+		return NULL;
+	}
+	if (lector->inicio == lector->fin)
+		return NULL;
+	char *linea = lector->buffer + lector->inicio;
+	if (largo)
+		*largo = lector->fin - lector->inicio;
+	lector->buffer[lector->fin] = '\0';
+	lector->inicio = lector->revisado = lector->fin;
+	return linea;
+}
+
+/*
+ * Devuelve true si la ultima lectura fallo por un error o por una linea
+ * demasiado larga.
+ */
+bool lector_hubo_error(lector_t *lector)
+{
+	return (!lector) ? true : lector->error;
+}
+
+/*
+ * Devuelve true si la ultima lectura devolvio NULL solo por una linea
+ * demasiado larga.
+ */
+bool lector_linea_demasiado_larga(lector_t *lector)
+{
+	return (!lector) ? false : lector->linea_larga;
+}
+
+/*
+ * Libera la memoria del lector y, si lo abrio lector_abrir(), cierra el
+ * archivo.
+ */
+void lector_destruir(lector_t *lector)
+{
+	if (!lector)
+		return;
+	if (lector->propio)
+		close(lector->descriptor);
+	free(lector->buffer);
+	free(lector);
+}
@@ -0,0 +1,65 @@
+#ifndef __LECTOR_H__
+#define __LECTOR_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct lector lector_t;
+
+/**
+ * Crea un lector de lineas sobre el descriptor de archivo recibido (por
+ * ejemplo, 0 para la entrada estandar). El lector lee en bloques grandes y
+ * entrega cada linea como una porcion de su propio buffer, sin copiarla.
+ *
+ * Las lineas pueden tener cualquier largo hasta largo_maximo caracteres (sin
+ * contar el salto de linea); el buffer crece lo necesario para contenerlas.
+ *
+ * El lector no cierra el descriptor al destruirse.
+ *
+ * Devuelve un puntero al lector creado o NULL en caso de error.
+ */
+lector_t *lector_crear(int descriptor, size_t largo_maximo);
+
+/**
+ * Abre el archivo indicado y crea un lector sobre el. El archivo se cierra al
+ * destruir el lector.
+ *
+ * Devuelve un puntero al lector creado o NULL en caso de error.
+ */
+lector_t *lector_abrir(const char *ruta, size_t largo_maximo);
+
+/**
+ * Devuelve la siguiente linea, sin el salto de linea y terminada en '\0', y
+ * guarda su largo en *largo (si no es NULL). La linea apunta al buffer del
+ * lector y solo es valida hasta la proxima llamada; puede modificarse.
+ *
+ * Devuelve NULL al llegar al final de la entrada o en caso de error. Si la
+ * linea supera el largo maximo tambien devuelve NULL, pero la descarta
+ * completa, por lo que se puede seguir leyendo desde la linea siguiente.
+ * lector_hubo_error() permite distinguir estos casos del final de la entrada,
+ * y lector_linea_demasiado_larga() una linea larga de un error de lectura.
+ */
+char *lector_leer_linea(lector_t *lector, size_t *largo);
+
+/**
+ * Devuelve true si la ultima llamada a lector_leer_linea() devolvio NULL por
+ * un error de lectura o por una linea demasiado larga, o false en caso
+ * contrario.
+ */
+bool lector_hubo_error(lector_t *lector);
+
+/**
+ * Devuelve true si la ultima llamada a lector_leer_linea() devolvio NULL por
+ * una linea demasiado larga (que se descarto), o false si fue por el final de
+ * la entrada o por un error de lectura, despues del cual no conviene seguir
+ * leyendo.
+ */
+bool lector_linea_demasiado_larga(lector_t *lector);
+
+/**
+ * Libera la memoria del lector y, si lo abrio lector_abrir(), cierra el
+ * archivo.
+ */
+void lector_destruir(lector_t *lector);
+
+#endif /* __LECTOR_H__ */
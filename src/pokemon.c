@@ -1,5 +1,6 @@
 #include "pokemon.h"
 #include <string.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "pokemon_privado.h"
 
@@ -20,14 +21,84 @@ pokemon_t *pokemon_crear_desde_string(const char *string)
 	if (!pokemon_creado)
 		return NULL;
 
-	if (sscanf(string, "%zu,%[^,],%zu,%[^,]", &pokemon_creado->id,
-		   pokemon_creado->nombre, &pokemon_creado->salud,
-		   pokemon_creado->nombre_entrenador) == 4)
+	if (pokemon_leer_desde_string(pokemon_creado, string))
 		return pokemon_creado;
 	free(pokemon_creado);
 	return NULL;
 }
 
+/**
+ * Lee un numero decimal sin signo a partir de *cursor (admitiendo espacios y
+ * un '+' antes del numero, como scanf) y deja *cursor en el primer caracter
+ * que no es un digito.
+ *
+ * Devuelve false si no hay ningun digito o si el numero no entra en un size_t.
+ */
+bool leer_numero_csv(const char **cursor, size_t *numero)
+{
+	const char *actual = *cursor;
+	while (*actual == ' ' || (*actual >= '\t' && *actual <= '\r'))
+		actual++;
+	if (*actual == '+')
+		actual++;
+	if (*actual < '0' || *actual > '9')
+		return false;
+	size_t valor = 0;
+	while (*actual >= '0' && *actual <= '9') {
+		size_t digito = (size_t)(*actual - '0');
+		if (valor > (SIZE_MAX - digito) / 10)
+			return false;
+		valor = valor * 10 + digito;
+		actual++;
+	}
+	*numero = valor;
+	*cursor = actual;
+	return true;
+}
+
+/**
+ * Copia en destino el campo que empieza en *cursor, hasta la siguiente coma o
+ * el final del string, y deja *cursor en ese delimitador.
+ *
+ * Devuelve false si el campo esta vacio o no entra en destino.
+ */
+bool leer_campo_csv(const char **cursor, char destino[MAX_NOMBRE])
+{
+	const char *actual = *cursor;
+	size_t largo = 0;
+	while (actual[largo] != ',' && actual[largo] != '\0') {
+		if (largo == MAX_NOMBRE - 1)
+			return false;
+		destino[largo] = actual[largo];
+		largo++;
+	}
+	if (largo == 0)
+		return false;
+	destino[largo] = '\0';
+	*cursor = actual + largo;
+	return true;
+}
+
+/**
+ * Completa el pokemon recibido (cuya memoria ya fue reservada por el llamador)
+ * con los datos de la línea en formato CSV. La línea se recorre una sola vez,
+ * escribiendo cada campo directamente en el pokemon; lo que siga al nombre
+ * del entrenador (a partir de una coma) se ignora.
+ *
+ * Devuelve false si el formato es incorrecto o si algun nombre no entra en
+ * el pokemon.
+ */
+bool pokemon_leer_desde_string(pokemon_t *pokemon, const char *string)
+{
+	if (!pokemon || !string)
+		return false;
+	const char *cursor = string;
+	return leer_numero_csv(&cursor, &pokemon->id) && *cursor++ == ',' &&
+	       leer_campo_csv(&cursor, pokemon->nombre) && *cursor++ == ',' &&
+	       leer_numero_csv(&cursor, &pokemon->salud) && *cursor++ == ',' &&
+	       leer_campo_csv(&cursor, pokemon->nombre_entrenador);
+}
+
 /**
  * Crea una copia del pokemon (reserva memoria para el mismo).
  *
@@ -1,6 +1,8 @@
 #ifndef POKEMON_PRIVADO_H_
 #define POKEMON_PRIVADO_H_
+#include <stdbool.h>
 #include <stdlib.h>
+#include "pokemon.h"
 
 // Este archivo es privado de la implementación, el usuario no lo conoce. Lo
 // declaramos por separado para que las pruebas puedan hacer uso de la
@@ -14,6 +16,18 @@ struct _pkm_t {
 	size_t salud;
 	char nombre_entrenador[MAX_NOMBRE];
 	char nombre[MAX_NOMBRE];
+	// Orden de ingreso al hospital que lo atiende. Lo asigna el hospital y
+	// desempata la prioridad de los pokemon con la misma salud.
+	size_t ingreso;
+	// Posicion del pokemon en el heap del hospital que lo atiende, que la
+	// mantiene actualizada para poder quitarlo o reubicarlo en O(log n).
+	size_t posicion;
 };
 
+// Completa un pokemon ya reservado (por ejemplo, dentro de la arena de un
+// hospital) con los datos de una línea <ID>,<NOMBRE>,<SALUD>,<ENTRENADOR>.
+// Devuelve false si el formato es incorrecto o si algun nombre no entra en
+// MAX_NOMBRE caracteres (contando el '\0').
+bool pokemon_leer_desde_string(pokemon_t *pokemon, const char *string);
+
 #endif // POKEMON_PRIVADO_H_
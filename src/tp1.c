@@ -1,209 +1,2248 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "tp1.h"
+#include "hospital.h"
+#include "hospital_privado.h"
 
 #include "pokemon.h"
+#include "pokemon_privado.h"
+#include "heap.h"
+#include "abb.h"
+#include "hash.h"
+#include "arena.h"
+#include "lector.h"
+#include "lista.h"
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-struct _hospital_pkm_t {
-	pokemon_t **pokemones;
-	size_t cantidad_pokemon;
-	size_t cantidad_entrenadores;
-};
+#define CAPACIDAD_INICIAL_HOSPITAL 16
+#define MAXIMO_CARACTERES_ID 32
+#define TAMANIO_BLOQUE_LECTURA 65536
+#define LARGO_ESTIMADO_LINEA 24
+#define LARGO_MAXIMO_LINEA (1 << 20)
+#define MAXIMO_HILOS 64
+#define MINIMO_BYTES_POR_HILO 65536
+#define MINIMO_POKEMON_POR_HILO 8192
+#define UMBRAL_ORDEN_PARALELO 65536
+#define MAXIMO_ORDENAMIENTO_POR_COMPARACION 64
+#define MAXIMO_RANGO_CONTEO 65536
+#define BITS_POR_DIGITO 8
+#define CANTIDAD_DIGITOS (1 << BITS_POR_DIGITO)
+
+/**
+ * Cantidad de hilos configurada con hospital_establecer_hilos(), o 0 para
+ * usar un hilo por procesador.
+*/
+size_t hilos_hospital = 0;
+
+/**
+ * Cantidad de pokemon a partir de la cual se ordena en paralelo, configurada
+ * con hospital_establecer_umbral_paralelo().
+*/
+size_t umbral_orden_paralelo = UMBRAL_ORDEN_PARALELO;
+
+/**
+ * Comparador del heap y del arbol de pokemones: tiene mas prioridad el
+ * pokemon con menos salud y, a igual salud, el que ingreso antes.
+*/
+int comparar_prioridad_pokemones(void *pokemon1, void *pokemon2)
+{
+	pokemon_t *p1 = pokemon1;
+	pokemon_t *p2 = pokemon2;
+	if (p1->salud != p2->salud)
+		return (p1->salud > p2->salud) - (p1->salud < p2->salud);
+	return (p1->ingreso > p2->ingreso) - (p1->ingreso < p2->ingreso);
+}
+
+/**
+ * Funcion con la que el heap del hospital avisa la posicion de cada pokemon,
+ * que se guarda en el propio pokemon.
+*/
+void actualizar_posicion_pokemon(void *pokemon, size_t posicion)
+{
+	((pokemon_t *)pokemon)->posicion = posicion;
+}
 
 /**
- * Reserva memoria para inicializar correctamente el hospital y el vector de pokemones que
- * incluye. 
- * 
+ * Reserva memoria para inicializar correctamente el hospital, el heap y el
+ * arbol de pokemones que incluye, a partir de un vector de pokemones ya
+ * ordenado por prioridad (que puede estar vacio). Ambas estructuras se
+ * construyen en tiempo lineal.
+ *
+ * Si se crea el hospital, pasa a ser dueño de la arena donde estan los
+ * pokemon del vector.
+ *
  * Devuelve un puntero al hospital creado o NULL en caso de error.
 */
-hospital_t *hospital_crear()
+hospital_t *hospital_crear(pokemon_t **ordenados, size_t cantidad,
+			   arena_t *registros)
 {
 	hospital_t *hospital_creado = calloc(1, sizeof(hospital_t));
 	if (!hospital_creado)
 		return NULL;
 
-	hospital_creado->pokemones = malloc(sizeof(pokemon_t *));
-	if (!hospital_creado->pokemones) {
+	hospital_creado->pokemones = heap_crear_desde_vector(
+		comparar_prioridad_pokemones, (void **)ordenados, cantidad);
+	hospital_creado->prioridades = abb_crear_desde_ordenados(
+		comparar_prioridad_pokemones, (void **)ordenados, cantidad);
+	hospital_creado->estadisticas = hash_crear(0);
+	bool exito = hospital_creado->pokemones &&
+		     hospital_creado->prioridades &&
+		     hospital_creado->estadisticas;
+	for (size_t i = 0; exito && i < cantidad; i++) {
+		exito = sumar_a_entrenador(hospital_creado, ordenados[i]);
+		hospital_creado->suma_salud += ordenados[i]->salud;
+	}
+	if (!exito) {
+		heap_destruir(hospital_creado->pokemones);
+		abb_destruir(hospital_creado->prioridades);
+		destruir_estadisticas(hospital_creado->estadisticas);
 		free(hospital_creado);
 		return NULL;
 	}
+	heap_seguir_posiciones(hospital_creado->pokemones,
+			       actualizar_posicion_pokemon);
+	hospital_creado->registros = registros;
+	hospital_creado->proximo_ingreso = cantidad;
 	return hospital_creado;
 }
 
 /**
- * Agranda el tamaño de la memoria asignada para el vector de pokemones del hospital, en base a
- * la nueva capacidad recibida por parametro.
- * 
- * Devuelve un puntero al nuevo vector o NULL en caso de error.
+ * Escribe en clave el id del pokemon como string, para usarlo como clave del
+ * indice por id.
 */
-pokemon_t **agrandar_vector_pokemon(pokemon_t **vector, size_t capacidad)
+void clave_id(size_t id, char clave[MAXIMO_CARACTERES_ID])
 {
-	pokemon_t **nuevo_vector =
-		realloc(vector, sizeof(pokemon_t *) * capacidad);
-	return nuevo_vector;
+	snprintf(clave, MAXIMO_CARACTERES_ID, "%zu", id);
 }
 
 /**
- * Lee un archivo con pokemones y crea un hospital con esos pokemones.
+ * Agrega el pokemon a la lista de pokemon con la clave indicada en el indice,
+ * creando la lista si es el primero.
  *
- * Si alguna de las líneas del archivo se encuentra mal formateada, debe ser considerado un error.
+ * Devuelve false en caso de error.
+*/
+bool indexar_con_clave(hash_t *indice, const char *clave, pokemon_t *pokemon)
+{
+	lista_t *pokemones = hash_obtener(indice, clave);
+	if (!pokemones) {
+		pokemones = lista_crear();
+		if (!pokemones)
+			return false;
+		if (!hash_insertar(indice, clave, pokemones, NULL)) {
+			lista_destruir(pokemones);
+			return false;
+		}
+	}
+	return lista_insertar(pokemones, pokemon) != NULL;
+}
+
+/**
+ * Funciones para agregar el pokemon al indice por id, por nombre o por
+ * entrenador. Devuelven false en caso de error.
+*/
+bool indexar_id(hash_t *indice, pokemon_t *pokemon)
+{
+	char clave[MAXIMO_CARACTERES_ID];
+	clave_id(pokemon->id, clave);
+	return indexar_con_clave(indice, clave, pokemon);
+}
+
+bool indexar_nombre(hash_t *indice, pokemon_t *pokemon)
+{
+	return indexar_con_clave(indice, pokemon->nombre, pokemon);
+}
+
+bool indexar_entrenador(hash_t *indice, pokemon_t *pokemon)
+{
+	return indexar_con_clave(indice, pokemon->nombre_entrenador, pokemon);
+}
+
+/**
+ * Busqueda de un pokemon dentro de una lista de un indice, utilizada por
+ * desindexar_con_clave().
+*/
+typedef struct busqueda_en_lista {
+	pokemon_t *buscado;
+	size_t posicion;
+	bool encontrado;
+} busqueda_en_lista_t;
+
+/**
+ * Funcion utilizada por desindexar_con_clave() que avanza la posicion hasta
+ * encontrar el pokemon buscado.
+*/
+bool avanzar_hasta_pokemon(void *pokemon, void *busqueda)
+{
+	busqueda_en_lista_t *datos = busqueda;
+	datos->encontrado = pokemon == datos->buscado;
+	if (!datos->encontrado)
+		datos->posicion++;
+	return !datos->encontrado;
+}
+
+/**
+ * Quita el pokemon de la lista con la clave indicada en el indice, y la lista
+ * del indice si queda vacia. Cuesta la cantidad de pokemon con esa clave.
+*/
+void desindexar_con_clave(hash_t *indice, const char *clave,
+			  pokemon_t *pokemon)
+{
+	lista_t *pokemones = hash_obtener(indice, clave);
+	busqueda_en_lista_t busqueda = { .buscado = pokemon };
+	lista_con_cada_elemento(pokemones, avanzar_hasta_pokemon, &busqueda);
+	if (!busqueda.encontrado)
+		return;
+	lista_quitar_de_posicion(pokemones, busqueda.posicion);
+	if (lista_vacia(pokemones)) {
+		hash_quitar(indice, clave);
+		lista_destruir(pokemones);
+	}
+}
+
+/**
+ * Funcion utilizada por primero_con_clave() que se queda con el pokemon que
+ * ingreso primero.
+*/
+bool elegir_primer_ingreso(void *pokemon, void *primero)
+{
+	pokemon_t **elegido = primero;
+	if (!*elegido || ((pokemon_t *)pokemon)->ingreso < (*elegido)->ingreso)
+		*elegido = pokemon;
+	return true;
+}
+
+/**
+ * Devuelve, de los pokemon con la clave indicada en el indice, el que ingreso
+ * primero al hospital, o NULL si no hay ninguno.
+*/
+pokemon_t *primero_con_clave(hash_t *indice, const char *clave)
+{
+	pokemon_t *primero = NULL;
+	lista_con_cada_elemento(hash_obtener(indice, clave),
+				elegir_primer_ingreso, &primero);
+	return primero;
+}
+
+/**
+ * Destructor de las listas de los indices.
+*/
+void destruir_lista_indice(void *pokemones)
+{
+	lista_destruir(pokemones);
+}
+
+/**
+ * Libera un indice junto con sus listas.
+*/
+void destruir_indice(hash_t *indice)
+{
+	hash_destruir_todo(indice, destruir_lista_indice);
+}
+
+/**
+ * Ingresa un pokemon al hospital asignandole el siguiente numero de ingreso
+ * y agregandolo al arbol y al heap. Si no puede agregarlo a ambos, no lo
+ * agrega a ninguno.
  *
- * Si el archivo no contiene al menos un pokemon, se debe devolver NULL
+ * Tambien se suma a las estadisticas de su entrenador. Los indices que
+ * existan (por id, por nombre y por entrenador) tambien se actualizan; si eso
+ * falla, el indice se descarta y se vuelve a construir en la proxima
+ * consulta.
  *
- * Devuelve NULL en caso de no poder crearlo.
+ * Devuelve false en caso de error.
+*/
+bool ingresar_pokemon(hospital_t *hospital, pokemon_t *pokemon)
+{
+	pokemon->ingreso = hospital->proximo_ingreso;
+	if (!sumar_a_entrenador(hospital, pokemon))
+		return false;
+	if (!abb_insertar(hospital->prioridades, pokemon)) {
+		restar_de_entrenador(hospital, pokemon->nombre_entrenador,
+				     pokemon->salud);
+		return false;
+	}
+	if (!heap_insertar(hospital->pokemones, pokemon)) {
+		abb_quitar(hospital->prioridades, pokemon);
+		restar_de_entrenador(hospital, pokemon->nombre_entrenador,
+				     pokemon->salud);
+		return false;
+	}
+	hospital->proximo_ingreso++;
+	hospital->suma_salud += pokemon->salud;
+	descartar_version(hospital);
+	if (hospital->indice_id && !indexar_id(hospital->indice_id, pokemon)) {
+		destruir_indice(hospital->indice_id);
+		hospital->indice_id = NULL;
+	}
+	if (hospital->indice_nombre &&
+	    !indexar_nombre(hospital->indice_nombre, pokemon)) {
+		destruir_indice(hospital->indice_nombre);
+		hospital->indice_nombre = NULL;
+	}
+	if (hospital->indice_entrenador &&
+	    !indexar_entrenador(hospital->indice_entrenador, pokemon)) {
+		destruir_indice(hospital->indice_entrenador);
+		hospital->indice_entrenador = NULL;
+	}
+	return true;
+}
+
+/**
+ * Quita del hospital el pokemon recibido (que debe estar en el hospital): del
+ * heap, del arbol, de los indices que existan y de las estadisticas de su
+ * entrenador, en O(log n) mas la cantidad de pokemon con su mismo id, nombre
+ * o entrenador. El pokemon sigue ocupando su memoria (propia o de la arena).
+*/
+void quitar_pokemon(hospital_t *hospital, pokemon_t *pokemon)
+{
+	heap_quitar(hospital->pokemones, pokemon->posicion);
+	descartar_version(hospital);
+	abb_quitar(hospital->prioridades, pokemon);
+	if (hospital->indice_id) {
+		char clave[MAXIMO_CARACTERES_ID];
+		clave_id(pokemon->id, clave);
+		desindexar_con_clave(hospital->indice_id, clave, pokemon);
+	}
+	if (hospital->indice_nombre)
+		desindexar_con_clave(hospital->indice_nombre, pokemon->nombre,
+				     pokemon);
+	if (hospital->indice_entrenador)
+		desindexar_con_clave(hospital->indice_entrenador,
+				     pokemon->nombre_entrenador, pokemon);
+	restar_de_entrenador(hospital, pokemon->nombre_entrenador,
+			     pokemon->salud);
+	hospital->suma_salud -= pokemon->salud;
+}
+
+/**
+ * Quita del hospital el pokemon de mayor prioridad, igual que
+ * quitar_pokemon().
+ *
+ * Devuelve el pokemon quitado o NULL si el hospital esta vacio.
+*/
+pokemon_t *quitar_primer_pokemon(hospital_t *hospital)
+{
+	pokemon_t *pokemon = heap_raiz(hospital->pokemones);
+	if (pokemon)
+		quitar_pokemon(hospital, pokemon);
+	return pokemon;
+}
+
+/**
+ * Cambia la salud del pokemon (que debe estar en el hospital) y lo reubica en
+ * el arbol y en el heap, en O(log n), actualizando las estadisticas de su
+ * entrenador. Conserva su orden de ingreso.
+ *
+ * El arbol reutiliza para la insercion el nodo que libera al quitarlo, por lo
+ * que reubicarlo no puede fallar.
+*/
+void cambiar_salud_pokemon(hospital_t *hospital, pokemon_t *pokemon,
+			   size_t nueva_salud)
+{
+	descartar_version(hospital);
+	size_t salud_anterior = pokemon->salud;
+	abb_quitar(hospital->prioridades, pokemon);
+	pokemon->salud = nueva_salud;
+	hospital->suma_salud = hospital->suma_salud - salud_anterior +
+			       nueva_salud;
+	abb_insertar(hospital->prioridades, pokemon);
+	heap_reubicar(hospital->pokemones, pokemon->posicion);
+	cambiar_salud_de_entrenador(hospital, pokemon, salud_anterior);
+}
+
+/**
+ * Establece la cantidad de hilos que usa el hospital para cargar y ordenar
+ * muchos pokemon. Con 0 se usa un hilo por procesador disponible.
  */
-hospital_t *hospital_crear_desde_archivo(const char *nombre_archivo)
+void hospital_establecer_hilos(size_t hilos)
 {
-	if (!nombre_archivo)
-		return NULL;
-	FILE *archivo = fopen(nombre_archivo, "r");
-	if (!archivo)
-		return NULL;
+	hilos_hospital = hilos;
+}
 
-	hospital_t *hospital = hospital_crear();
-	if (!hospital) {
-		fclose(archivo);
-		return NULL;
+/**
+ * Establece la cantidad minima de pokemon a partir de la cual el hospital
+ * los ordena en paralelo.
+ */
+void hospital_establecer_umbral_paralelo(size_t cantidad)
+{
+	umbral_orden_paralelo = cantidad;
+}
+
+/**
+ * Devuelve la cantidad de hilos a usar para procesar un volumen de datos del
+ * tamaño indicado: la configurada (o un hilo por procesador), pero sin
+ * asignarle a ningun hilo menos del minimo de datos por hilo indicado.
+*/
+size_t cantidad_hilos(size_t tamanio, size_t minimo_por_hilo)
+{
+	size_t hilos = hilos_hospital;
+	if (hilos == 0) {
+		long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+		hilos = (procesadores > 0) ? (size_t)procesadores : 1;
+	}
+	if (hilos > MAXIMO_HILOS)
+		hilos = MAXIMO_HILOS;
+	if (hilos > tamanio / minimo_por_hilo)
+		hilos = tamanio / minimo_por_hilo;
+	return (hilos == 0) ? 1 : hilos;
+}
+
+/**
+ * Ejecuta la funcion con cada una de las tareas del vector, cada una en un
+ * hilo distinto (la primera en el hilo actual), y espera a que terminen
+ * todas. Si no se puede lanzar algun hilo, su tarea se ejecuta en el hilo
+ * actual.
+*/
+void ejecutar_en_hilos(void *(*funcion)(void *), void *tareas,
+		       size_t tamanio_tarea, size_t cantidad)
+{
+	pthread_t hilos[MAXIMO_HILOS];
+	bool lanzados[MAXIMO_HILOS] = { false };
+	char *tarea = tareas;
+	for (size_t i = 1; i < cantidad; i++)
+		lanzados[i] = pthread_create(&hilos[i], NULL, funcion,
+					     tarea + i * tamanio_tarea) == 0;
+	funcion(tarea);
+	for (size_t i = 1; i < cantidad; i++) {
+		if (lanzados[i])
+			pthread_join(hilos[i], NULL);
+		else
+			funcion(tarea + i * tamanio_tarea);
+	}
+}
+
+/**
+ * Vista por columnas de los pokemon cargados: la salud de cada pokemon en un
+ * vector contiguo (indexado por orden de carga) y una permutacion de esos
+ * indices que, una vez ordenada, da el orden de prioridad. Ordenar solo lee
+ * la columna de salud, sin acceder a los registros completos.
+*/
+typedef struct columnas {
+	size_t *saludes;
+	size_t *permutacion;
+	size_t *auxiliar;
+	size_t cantidad;
+} columnas_t;
+
+/**
+ * Libera los vectores de la vista por columnas.
+*/
+void columnas_destruir(columnas_t *columnas)
+{
+	free(columnas->saludes);
+	free(columnas->permutacion);
+	free(columnas->auxiliar);
+}
+
+/**
+ * Construye la vista por columnas de los pokemon recibidos, con la
+ * permutacion identidad.
+ *
+ * Devuelve false en caso de error.
+*/
+bool columnas_crear(columnas_t *columnas, pokemon_t **pokemones,
+		    size_t cantidad)
+{
+	columnas->cantidad = cantidad;
+	columnas->saludes = malloc(sizeof(size_t) * cantidad);
+	columnas->permutacion = malloc(sizeof(size_t) * cantidad);
+	columnas->auxiliar = malloc(sizeof(size_t) * cantidad);
+	if (!columnas->saludes || !columnas->permutacion ||
+	    !columnas->auxiliar) {
+		columnas_destruir(columnas);
+		return false;
+	}
+	for (size_t i = 0; i < cantidad; i++) {
+		columnas->saludes[i] = pokemones[i]->salud;
+		columnas->permutacion[i] = i;
+	}
+	return true;
+}
+
+/**
+ * Ordena el tramo de la permutacion de menor a mayor salud utilizando
+ * mergesort. El ordenamiento es estable: los pokemon con la misma salud
+ * conservan el orden en el que llegaron.
+*/
+void mergesort_por_salud(const size_t *saludes, size_t *permutacion,
+			 size_t *auxiliar, size_t cantidad)
+{
+	if (cantidad < 2)
+		return;
+	size_t mitad = cantidad / 2;
+	mergesort_por_salud(saludes, permutacion, auxiliar, mitad);
+	mergesort_por_salud(saludes, permutacion + mitad, auxiliar,
+			    cantidad - mitad);
+	if (saludes[permutacion[mitad - 1]] <= saludes[permutacion[mitad]])
+		return;
+
+	size_t izquierda = 0, derecha = mitad, k = 0;
+	while (izquierda < mitad && derecha < cantidad) {
+		if (saludes[permutacion[derecha]] <
+		    saludes[permutacion[izquierda]])
+			auxiliar[k++] = permutacion[derecha++];
+		else
+			auxiliar[k++] = permutacion[izquierda++];
 	}
+	while (izquierda < mitad)
+		auxiliar[k++] = permutacion[izquierda++];
+	while (derecha < cantidad)
+		auxiliar[k++] = permutacion[derecha++];
+	memcpy(permutacion, auxiliar, sizeof(size_t) * cantidad);
+}
+
+/**
+ * Ordena la permutacion por salud con counting sort, para saludes en el
+ * rango [minimo, minimo + rango). Recorrer la permutacion en orden al
+ * repartir hace que el ordenamiento sea estable.
+ *
+ * Devuelve false en caso de error.
+*/
+bool conteo_por_salud(const size_t *saludes, size_t *permutacion,
+		      size_t *auxiliar, size_t cantidad, size_t minimo,
+		      size_t rango)
+{
+	size_t *posiciones = calloc(rango, sizeof(size_t));
+	if (!posiciones)
+		return false;
+	for (size_t i = 0; i < cantidad; i++)
+		posiciones[saludes[permutacion[i]] - minimo]++;
+	size_t acumulado = 0;
+	for (size_t valor = 0; valor < rango; valor++) {
+		size_t repeticiones = posiciones[valor];
+		posiciones[valor] = acumulado;
+		acumulado += repeticiones;
+	}
+	for (size_t i = 0; i < cantidad; i++)
+		auxiliar[posiciones[saludes[permutacion[i]] - minimo]++] =
+			permutacion[i];
+	memcpy(permutacion, auxiliar, sizeof(size_t) * cantidad);
+	free(posiciones);
+	return true;
+}
 
-	char linea[30] = { 0 };
-	while (fscanf(archivo, "%[^\n]\n", linea) == 1) {
-		pokemon_t *pokemon_leido = pokemon_crear_desde_string(linea);
-		hospital->pokemones = agrandar_vector_pokemon(
-			hospital->pokemones, hospital->cantidad_pokemon + 1);
-		if (!pokemon_leido || !hospital->pokemones) {
-			if (pokemon_leido)
-				pokemon_destruir(pokemon_leido);
-			hospital_destruir(hospital);
-			fclose(archivo);
-			return NULL;
+/**
+ * Ordena la permutacion por salud con radix sort LSD, de a
+ * BITS_POR_DIGITO bits por pasada, sobre la salud relativa al minimo. Solo
+ * se hacen las pasadas necesarias para cubrir el rango de saludes. Cada
+ * pasada es un counting sort estable, por lo que el resultado tambien lo es.
+*/
+void radix_por_salud(const size_t *saludes, size_t *permutacion,
+		     size_t *auxiliar, size_t cantidad, size_t minimo,
+		     size_t maximo)
+{
+	size_t *origen = permutacion, *destino = auxiliar;
+	for (size_t desplazamiento = 0;
+	     desplazamiento < sizeof(size_t) * 8 &&
+	     ((maximo - minimo) >> desplazamiento) > 0;
+	     desplazamiento += BITS_POR_DIGITO) {
+		size_t posiciones[CANTIDAD_DIGITOS] = { 0 };
+		for (size_t i = 0; i < cantidad; i++)
+			posiciones[((saludes[origen[i]] - minimo) >>
+				    desplazamiento) &
+				   (CANTIDAD_DIGITOS - 1)]++;
+		size_t acumulado = 0;
+		for (size_t digito = 0; digito < CANTIDAD_DIGITOS; digito++) {
+			size_t repeticiones = posiciones[digito];
+			posiciones[digito] = acumulado;
+			acumulado += repeticiones;
 		}
-		hospital->cantidad_pokemon++;
-		hospital->pokemones[hospital->cantidad_pokemon - 1] =
-			pokemon_leido;
+		for (size_t i = 0; i < cantidad; i++)
+			destino[posiciones[((saludes[origen[i]] - minimo) >>
+					    desplazamiento) &
+					   (CANTIDAD_DIGITOS - 1)]++] = origen[i];
+		size_t *intercambio = origen;
+		origen = destino;
+		destino = intercambio;
 	}
+	if (origen != permutacion)
+		memcpy(permutacion, origen, sizeof(size_t) * cantidad);
+}
 
-	fclose(archivo);
-	if (!hospital->cantidad_pokemon) {
-		hospital_destruir(hospital);
-		return NULL;
+/**
+ * Ordena un tramo de la permutacion por salud de forma estable, eligiendo el
+ * algoritmo segun los datos: mergesort para pocos pokemon, counting sort si
+ * el rango de saludes es acotado (el caso comun, saludes de 0 a 100) y radix
+ * sort si el rango es amplio. Los dos ultimos son lineales.
+ *
+ * Devuelve false en caso de error.
+*/
+bool ordenar_tramo_por_salud(const size_t *saludes, size_t *permutacion,
+			     size_t *auxiliar, size_t cantidad)
+{
+	if (cantidad <= MAXIMO_ORDENAMIENTO_POR_COMPARACION) {
+		mergesort_por_salud(saludes, permutacion, auxiliar, cantidad);
+		return true;
 	}
-	return hospital;
+	size_t minimo = saludes[permutacion[0]], maximo = minimo;
+	for (size_t i = 1; i < cantidad; i++) {
+		size_t salud = saludes[permutacion[i]];
+		if (salud < minimo)
+			minimo = salud;
+		if (salud > maximo)
+			maximo = salud;
+	}
+	if (maximo - minimo < MAXIMO_RANGO_CONTEO)
+		return conteo_por_salud(saludes, permutacion, auxiliar,
+					cantidad, minimo, maximo - minimo + 1);
+	radix_por_salud(saludes, permutacion, auxiliar, cantidad, minimo,
+			maximo);
+	return true;
 }
 
 /**
- * Devuelve la cantidad de pokemon que son atendidos actualmente en el hospital.
- */
-size_t hospital_cantidad_pokemones(hospital_t *hospital)
+ * Tarea de un hilo del ordenamiento en paralelo: ordenar un tramo de la
+ * permutacion, o fusionar dos tramos consecutivos ya ordenados (el primero de
+ * largo mitad) dejando el resultado en destino.
+*/
+typedef struct tarea_orden {
+	const size_t *saludes;
+	size_t *origen;
+	size_t *destino;
+	size_t cantidad;
+	size_t mitad;
+	bool exito;
+} tarea_orden_t;
+
+/**
+ * Ordena el tramo de la tarea, usando su destino como vector auxiliar. Tiene
+ * la firma de las funciones que ejecuta pthread_create().
+*/
+void *ordenar_tarea(void *tarea)
 {
-	return (!hospital) ? 0 : hospital->cantidad_pokemon;
+	tarea_orden_t *datos = tarea;
+	datos->exito = ordenar_tramo_por_salud(datos->saludes, datos->origen,
+					       datos->destino, datos->cantidad);
+	return NULL;
 }
 
 /**
- * Funcion utilizada en hospital_a_cada_pokemon() que permite ordenar los pokemon dentro del hospital 
- * de menor a mayor salud. Se utiliza el ordenamiento por INSERCIÓN.
+ * Fusiona los dos tramos ordenados de la tarea en su destino. A igual salud
+ * va primero el del primer tramo, lo que mantiene la estabilidad. Tiene la
+ * firma de las funciones que ejecuta pthread_create().
 */
-void ordenar_pokemones_por_salud(hospital_t *hospital)
+void *fusionar_tarea(void *tarea)
 {
-	for (size_t i = 1; i < hospital->cantidad_pokemon; i++) {
-		pokemon_t *pokemon_aux = hospital->pokemones[i];
-		size_t j = 1;
-		bool anterior_mayor =
-			pokemon_salud(hospital->pokemones[i - 1]) >
-			pokemon_salud(hospital->pokemones[i]);
-		while (anterior_mayor == true && j <= i) {
-			hospital->pokemones[i - j + 1] =
-				hospital->pokemones[i - j];
-			if (j == i ||
-			    pokemon_salud(hospital->pokemones[i - j - 1]) <
-				    pokemon_salud(pokemon_aux)) {
-				hospital->pokemones[i - j] = pokemon_aux;
-				break;
-			}
-			j++;
+	tarea_orden_t *datos = tarea;
+	const size_t *saludes = datos->saludes;
+	size_t *origen = datos->origen, *destino = datos->destino;
+	size_t izquierda = 0, derecha = datos->mitad, k = 0;
+	while (izquierda < datos->mitad && derecha < datos->cantidad) {
+		if (saludes[origen[derecha]] < saludes[origen[izquierda]])
+			destino[k++] = origen[derecha++];
+		else
+			destino[k++] = origen[izquierda++];
+	}
+	while (izquierda < datos->mitad)
+		destino[k++] = origen[izquierda++];
+	while (derecha < datos->cantidad)
+		destino[k++] = origen[derecha++];
+	datos->exito = true;
+	return NULL;
+}
+
+/**
+ * Ordena la permutacion en paralelo: cada hilo ordena un tramo consecutivo y
+ * luego los tramos se fusionan de a pares, tambien en paralelo, hasta que
+ * queda uno solo. Como cada fusion respeta el orden de los tramos, el
+ * resultado es estable.
+ *
+ * Devuelve false en caso de error.
+*/
+bool ordenar_en_paralelo(columnas_t *columnas, size_t cantidad_tramos)
+{
+	tarea_orden_t tareas[MAXIMO_HILOS];
+	size_t limites[MAXIMO_HILOS + 1];
+	size_t cantidad = columnas->cantidad;
+	for (size_t i = 0; i <= cantidad_tramos; i++)
+		limites[i] = cantidad / cantidad_tramos * i;
+	limites[cantidad_tramos] = cantidad;
+	for (size_t i = 0; i < cantidad_tramos; i++)
+		tareas[i] = (tarea_orden_t){
+			.saludes = columnas->saludes,
+			.origen = columnas->permutacion + limites[i],
+			.destino = columnas->auxiliar + limites[i],
+			.cantidad = limites[i + 1] - limites[i],
+		};
+	ejecutar_en_hilos(ordenar_tarea, tareas, sizeof(tarea_orden_t),
+			  cantidad_tramos);
+	for (size_t i = 0; i < cantidad_tramos; i++)
+		if (!tareas[i].exito)
+			return false;
+
+	size_t *origen = columnas->permutacion, *destino = columnas->auxiliar;
+	while (cantidad_tramos > 1) {
+		size_t fusiones = 0;
+		for (size_t i = 0; i < cantidad_tramos; i += 2) {
+			size_t fin = (i + 2 <= cantidad_tramos) ?
+					     limites[i + 2] :
+					     limites[i + 1];
+			tareas[fusiones++] = (tarea_orden_t){
+				.saludes = columnas->saludes,
+				.origen = origen + limites[i],
+				.destino = destino + limites[i],
+				.cantidad = fin - limites[i],
+				.mitad = limites[i + 1] - limites[i],
+			};
 		}
+		ejecutar_en_hilos(fusionar_tarea, tareas, sizeof(tarea_orden_t),
+				  fusiones);
+		for (size_t i = 0; i < fusiones; i++)
+			limites[i] = limites[2 * i];
+		limites[fusiones] = cantidad;
+		cantidad_tramos = fusiones;
+		size_t *intercambio = origen;
+		origen = destino;
+		destino = intercambio;
 	}
+	if (origen != columnas->permutacion)
+		memcpy(columnas->permutacion, origen, sizeof(size_t) * cantidad);
+	return true;
 }
 
 /**
- * Aplica una función a cada uno de los pokemon almacenados en el hospital. La
- * función debe aplicarse a cada pokemon en orden de prioridad (los de menor salud primero).
+ * Ordena la permutacion de las columnas por salud de forma estable. A partir
+ * del umbral configurado, si hay mas de un hilo disponible, se ordena en
+ * paralelo.
  *
- * La función a aplicar recibe el pokemon y la variable auxiliar que se le paso a hospital_a_cada_pokemon
- * y devuelve true o false. Si la función devuelve true, se debe seguir aplicando la función a los próximos 
- * pokemon si quedan. Si la función devuelve false, no se debe continuar.
+ * Devuelve false en caso de error.
+*/
+bool ordenar_por_salud(columnas_t *columnas)
+{
+	size_t hilos =
+		cantidad_hilos(columnas->cantidad, MINIMO_POKEMON_POR_HILO);
+	if (columnas->cantidad >= umbral_orden_paralelo && hilos > 1)
+		return ordenar_en_paralelo(columnas, hilos);
+	return ordenar_tramo_por_salud(columnas->saludes, columnas->permutacion,
+				       columnas->auxiliar, columnas->cantidad);
+}
+
+/**
+ * Ordena los pokemon cargados por prioridad. El orden se calcula sobre la
+ * vista por columnas y recien al final se reubican los punteros a los
+ * registros segun la permutacion obtenida.
  *
- * Devuelve la cantidad de veces que se invocó la función (haya devuelto true o false).
- */
-size_t hospital_a_cada_pokemon(hospital_t *hospital,
-			       bool (*funcion)(pokemon_t *p, void *aux),
-			       void *aux)
+ * Devuelve false en caso de error.
+*/
+bool ordenar_carga_por_prioridad(pokemon_t **pokemones, size_t cantidad)
 {
-	size_t iteracion = 0;
-	if (!hospital || !funcion)
-		return iteracion;
-	ordenar_pokemones_por_salud(hospital);
-	for (size_t i = 0; i < hospital->cantidad_pokemon; i++) {
-		iteracion++;
-		if (!funcion(hospital->pokemones[i], aux))
-			break;
+	columnas_t columnas;
+	if (!columnas_crear(&columnas, pokemones, cantidad))
+		return false;
+	pokemon_t **ordenados = NULL;
+	if (ordenar_por_salud(&columnas))
+		ordenados = malloc(sizeof(pokemon_t *) * cantidad);
+	if (!ordenados) {
+		columnas_destruir(&columnas);
+		return false;
 	}
-	return iteracion;
+	for (size_t i = 0; i < cantidad; i++)
+		ordenados[i] = pokemones[columnas.permutacion[i]];
+	memcpy(pokemones, ordenados, sizeof(pokemon_t *) * cantidad);
+	free(ordenados);
+	columnas_destruir(&columnas);
+	return true;
 }
 
 /**
- *  Cuando ocurre una emergencia, llegan nuevos pokemones en ambulancia, que
- *  deben ser ingresados al hospital.
+ * Ordena por prioridad los indices de un vector de saludes, con los mismos
+ * algoritmos que ordenar_carga_por_prioridad(). El vector de saludes no se
+ * modifica ni se libera.
  *
- *  No es necesario copiar los pokemon, tenes que quedarte con el puntero.
- *  Recorda que a partir del momento que te guardas el puntero pasas a ser
- *  responsable de la liberación de los pokemon.
+ * Devuelve la permutacion obtenida o NULL en caso de error.
+*/
+size_t *ordenar_saludes_por_prioridad(size_t *saludes, size_t cantidad)
+{
+	columnas_t columnas = { .saludes = saludes, .cantidad = cantidad };
+	columnas.permutacion = malloc(sizeof(size_t) * cantidad);
+	columnas.auxiliar = malloc(sizeof(size_t) * cantidad);
+	bool exito = columnas.permutacion && columnas.auxiliar;
+	if (exito) {
+		for (size_t i = 0; i < cantidad; i++)
+			columnas.permutacion[i] = i;
+		exito = ordenar_por_salud(&columnas);
+	}
+	size_t *permutacion = (exito) ? columnas.permutacion : NULL;
+	if (exito)
+		columnas.permutacion = NULL;
+	columnas.saludes = NULL;
+	columnas_destruir(&columnas);
+	return permutacion;
+}
+
+/**
+ * Vector dinamico donde se acumulan los pokemon leidos de un archivo, en el
+ * orden en que aparecen, junto con la arena de donde se reservan.
+*/
+typedef struct carga {
+	arena_t *registros;
+	pokemon_t **pokemones;
+	size_t cantidad;
+	size_t capacidad;
+} carga_t;
+
+/**
+ * Prepara una carga para los pokemon de un texto del tamaño indicado,
+ * reservando de entrada la arena y el vector para la cantidad de lineas
+ * estimada. Si el texto resulta tener mas lineas, ambos crecen
+ * geometricamente.
  *
- *  Devuelve -1 en caso de error o 0 en caso de éxito
- */
-int hospital_aceptar_emergencias(hospital_t *hospital,
-				 pokemon_t **pokemones_ambulancia,
-				 size_t cant_pokes_ambulancia)
+ * Devuelve false en caso de error.
+*/
+bool carga_inicializar(carga_t *carga, size_t tamanio)
 {
-	if (!hospital || !pokemones_ambulancia)
-		return ERROR;
-	pokemon_t **nuevo_vector = agrandar_vector_pokemon(
-		hospital->pokemones,
-		hospital->cantidad_pokemon + cant_pokes_ambulancia);
-	if (!nuevo_vector)
-		return ERROR;
-	hospital->pokemones = nuevo_vector;
-	for (size_t i = 0; i < cant_pokes_ambulancia; i++)
-		hospital->pokemones[hospital->cantidad_pokemon + i] =
-			pokemones_ambulancia[i];
-	hospital->cantidad_pokemon += cant_pokes_ambulancia;
-	return EXITO;
+	size_t estimacion = tamanio / LARGO_ESTIMADO_LINEA + 1;
+	carga->registros = arena_crear(sizeof(pokemon_t), estimacion);
+	if (!carga->registros)
+		return false;
+	carga->pokemones = malloc(sizeof(pokemon_t *) * estimacion);
+	carga->capacidad = (carga->pokemones) ? estimacion : 0;
+	return true;
 }
 
 /**
- * Devuelve el pokemon con la prioridad indicada (siendo 0 la mas alta prioridad, el pokemon con menos salúd).
+ * Agrega un pokemon a la carga, duplicando la capacidad del vector cuando se
+ * llena para que el costo total de las copias sea lineal.
  *
- * Si no existe la prioridad indicada devuelve NULL
- */
-pokemon_t *hospital_obtener_pokemon(hospital_t *hospital, size_t prioridad)
+ * Devuelve false en caso de error.
+*/
+bool carga_agregar(carga_t *carga, pokemon_t *pokemon)
 {
-	if (!hospital || prioridad >= hospital->cantidad_pokemon)
-		return NULL;
-	ordenar_pokemones_por_salud(hospital);
-	return hospital->pokemones[prioridad];
+	if (carga->cantidad == carga->capacidad) {
+		size_t capacidad = (carga->capacidad < CAPACIDAD_INICIAL_HOSPITAL) ?
+					   CAPACIDAD_INICIAL_HOSPITAL :
+					   carga->capacidad * 2;
+		pokemon_t **nuevo_vector = realloc(
+			carga->pokemones, sizeof(pokemon_t *) * capacidad);
+		if (!nuevo_vector)
+			return false;
+		carga->pokemones = nuevo_vector;
+		carga->capacidad = capacidad;
+	}
+	carga->pokemones[carga->cantidad++] = pokemon;
+	return true;
 }
 
 /**
- *  Libera el hospital y toda la memoria utilizada por el mismo.
- */
-void hospital_destruir(hospital_t *hospital)
+ * Libera los pokemon acumulados en la carga y el vector que los contiene.
+*/
+void carga_destruir(carga_t *carga)
 {
-	if (!hospital)
-		return;
-	for (int i = 0; i < hospital->cantidad_pokemon; i++)
-		pokemon_destruir(hospital->pokemones[i]);
-	free(hospital->pokemones);
+	arena_destruir(carga->registros);
+	free(carga->pokemones);
+}
+
+/**
+ * Devuelve el tamaño del archivo abierto en el descriptor, o 0 si no es un
+ * archivo regular (por ejemplo, un pipe) y por lo tanto no se conoce.
+*/
+size_t tamanio_archivo(int descriptor)
+{
+	struct stat estado;
+	if (fstat(descriptor, &estado) != 0 || !S_ISREG(estado.st_mode) ||
+	    estado.st_size < 0)
+		return 0;
+	return (size_t)estado.st_size;
+}
+
+/**
+ * Lee el archivo completo en bloques grandes y deja el contenido terminado en
+ * '\0'. El buffer se reserva para el tamaño esperado y se duplica si el
+ * archivo resulta mas grande.
+ *
+ * Devuelve el buffer (que debe liberarse con free) y guarda en *tamanio la
+ * cantidad de bytes leidos, o devuelve NULL en caso de error.
+*/
+char *leer_archivo(int descriptor, size_t esperado, size_t *tamanio)
+{
+	size_t capacidad = ((esperado < TAMANIO_BLOQUE_LECTURA) ?
+				    TAMANIO_BLOQUE_LECTURA :
+				    esperado) +
+			   1;
+	char *buffer = malloc(capacidad);
+	if (!buffer)
+		return NULL;
+	size_t usados = 0;
+	ssize_t leidos = 0;
+	do {
+		if (usados == capacidad - 1) {
+			char *nuevo_buffer = realloc(buffer, capacidad * 2);
+			if (!nuevo_buffer) {
+				free(buffer);
+				return NULL;
+			}
+			buffer = nuevo_buffer;
+			capacidad *= 2;
+		}
+		leidos = read(descriptor, buffer + usados,
+			      capacidad - usados - 1);
+		if (leidos > 0)
+			usados += (size_t)leidos;
+	} while (leidos > 0 || (leidos < 0 && errno == EINTR));
+	if (leidos < 0) {
+		free(buffer);
+		return NULL;
+	}
+	buffer[usados] = '\0';
+	*tamanio = usados;
+	return buffer;
+}
+
+/**
+ * Crea un pokemon en la arena de la carga a partir de la linea recibida y lo
+ * agrega a la carga. Las lineas vacias se ignoran.
+ *
+ * Devuelve false si la linea tiene un formato invalido o en caso de error.
+*/
+bool cargar_linea(carga_t *carga, const char *linea)
+{
+	if (*linea == '\0')
+		return true;
+	pokemon_t *pokemon_leido = arena_reservar(carga->registros);
+	if (!pokemon_leido)
+		return false;
+	if (!pokemon_leer_desde_string(pokemon_leido, linea) ||
+	    !carga_agregar(carga, pokemon_leido)) {
+		arena_liberar(carga->registros, pokemon_leido);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Tramo del contenido de un archivo que carga un hilo. Los tramos empiezan y
+ * terminan en un limite de linea, y cada uno acumula sus pokemon en una
+ * carga propia (con su propia arena) para que los hilos no compartan nada.
+*/
+typedef struct tramo {
+	char *inicio;
+	char *fin;
+	carga_t carga;
+	bool exito;
+} tramo_t;
+
+/**
+ * Carga las lineas del tramo recibido, procesandolas directamente dentro del
+ * buffer. Tiene la firma de las funciones que ejecuta pthread_create().
+*/
+void *cargar_tramo(void *tramo)
+{
+	tramo_t *datos = tramo;
+	datos->exito = carga_inicializar(&datos->carga,
+					 (size_t)(datos->fin - datos->inicio));
+	char *linea = datos->inicio;
+	while (datos->exito && linea < datos->fin) {
+		char *fin_linea =
+			memchr(linea, '\n', (size_t)(datos->fin - linea));
+		if (fin_linea)
+			*fin_linea = '\0';
+		datos->exito = cargar_linea(&datos->carga, linea);
+		linea = (fin_linea) ? fin_linea + 1 : datos->fin;
+	}
+	return NULL;
+}
+
+/**
+ * Divide el contenido en a lo sumo cantidad_tramos tramos de tamaño parecido,
+ * moviendo el final de cada tramo hasta despues del siguiente salto de
+ * linea.
+ *
+ * Devuelve la cantidad de tramos obtenidos.
+*/
+size_t dividir_en_tramos(char *contenido, size_t tamanio, tramo_t *tramos,
+			 size_t cantidad_tramos)
+{
+	size_t cantidad = 0;
+	char *inicio = contenido, *fin_contenido = contenido + tamanio;
+	for (size_t i = 1; i <= cantidad_tramos && inicio < fin_contenido;
+	     i++) {
+		char *fin = (i == cantidad_tramos) ?
+				    fin_contenido :
+				    contenido + tamanio / cantidad_tramos * i;
+		if (fin < inicio)
+			fin = inicio;
+		if (fin < fin_contenido) {
+			char *fin_linea =
+				memchr(fin, '\n', (size_t)(fin_contenido - fin));
+			fin = (fin_linea) ? fin_linea + 1 : fin_contenido;
+		}
+		tramos[cantidad++] = (tramo_t){ .inicio = inicio, .fin = fin };
+		inicio = fin;
+	}
+	return cantidad;
+}
+
+/**
+ * Junta en la carga recibida (vacia) los pokemon de todos los tramos, en el
+ * orden de los tramos. Las arenas de los tramos pasan a formar parte de la
+ * arena de la carga.
+ *
+ * Devuelve false en caso de error. Tanto si tiene exito como si no, lo que
+ * quede en cada tramo debe liberarse con carga_destruir().
+*/
+bool unir_tramos(tramo_t *tramos, size_t cantidad_tramos, carga_t *carga)
+{
+	size_t total = 0;
+	for (size_t i = 0; i < cantidad_tramos; i++)
+		total += tramos[i].carga.cantidad;
+	*carga = tramos[0].carga;
+	tramos[0].carga = (carga_t){ 0 };
+	if (carga->capacidad < total) {
+		pokemon_t **nuevo_vector =
+			realloc(carga->pokemones, sizeof(pokemon_t *) * total);
+		if (!nuevo_vector)
+			return false;
+		carga->pokemones = nuevo_vector;
+		carga->capacidad = total;
+	}
+	for (size_t i = 1; i < cantidad_tramos; i++) {
+		carga_t *parcial = &tramos[i].carga;
+		if (!arena_absorber(carga->registros, parcial->registros))
+			return false;
+		parcial->registros = NULL;
+		memcpy(carga->pokemones + carga->cantidad, parcial->pokemones,
+		       sizeof(pokemon_t *) * parcial->cantidad);
+		carga->cantidad += parcial->cantidad;
+	}
+	return true;
+}
+
+/**
+ * Carga los pokemon del contenido de un archivo. Si el contenido es grande se
+ * divide en tramos que se cargan en paralelo, uno por hilo, y luego se unen
+ * en el orden del archivo.
+ *
+ * Devuelve false si alguna linea es invalida o en caso de error.
+*/
+bool cargar_contenido(char *contenido, size_t tamanio, carga_t *carga)
+{
+	tramo_t tramos[MAXIMO_HILOS];
+	size_t cantidad_tramos =
+		dividir_en_tramos(contenido, tamanio, tramos,
+				  cantidad_hilos(tamanio, MINIMO_BYTES_POR_HILO));
+	if (cantidad_tramos == 0)
+		return true;
+
+	ejecutar_en_hilos(cargar_tramo, tramos, sizeof(tramo_t),
+			  cantidad_tramos);
+
+	bool exito = true;
+	for (size_t i = 0; i < cantidad_tramos; i++)
+		exito = exito && tramos[i].exito;
+	if (exito)
+		exito = unir_tramos(tramos, cantidad_tramos, carga);
+	for (size_t i = 0; i < cantidad_tramos; i++)
+		carga_destruir(&tramos[i].carga);
+	return exito;
+}
+
+/**
+ * Carga los pokemon del archivo abierto en el descriptor leyendo el archivo
+ * completo a memoria y dividiendolo en tramos que se cargan en paralelo.
+ *
+ * Devuelve false si alguna linea es invalida o en caso de error.
+*/
+bool cargar_en_paralelo(int descriptor, size_t tamanio, carga_t *carga)
+{
+	char *contenido = leer_archivo(descriptor, tamanio, &tamanio);
+	if (!contenido)
+		return false;
+	bool exito = cargar_contenido(contenido, tamanio, carga);
+	free(contenido);
+	return exito;
+}
+
+/**
+ * Carga los pokemon del archivo abierto en el descriptor linea por linea, sin
+ * leer el archivo completo a memoria. Se usa cuando el archivo es chico o no
+ * se conoce su tamaño.
+ *
+ * Devuelve false si alguna linea es invalida (o supera el largo maximo) o en
+ * caso de error.
+*/
+bool cargar_en_secuencia(int descriptor, size_t tamanio, carga_t *carga)
+{
+	lector_t *lector = lector_crear(descriptor, LARGO_MAXIMO_LINEA);
+	if (!lector)
+		return false;
+	bool exito = carga_inicializar(carga, tamanio);
+	char *linea = NULL;
+	while (exito && (linea = lector_leer_linea(lector, NULL)))
+		exito = cargar_linea(carga, linea);
+	if (exito && lector_hubo_error(lector))
+		exito = false;
+	lector_destruir(lector);
+	return exito;
+}
+
+/**
+ * Lee un archivo con pokemones y crea un hospital con esos pokemones.
+ *
+ * Si alguna de las líneas del archivo se encuentra mal formateada, debe ser considerado un error.
+ *
+ * Si el archivo no contiene al menos un pokemon, se debe devolver NULL
+ *
+ * Devuelve NULL en caso de no poder crearlo.
+ */
+hospital_t *hospital_crear_desde_archivo(const char *nombre_archivo)
+{
+	if (!nombre_archivo)
+		return NULL;
+	int descriptor = open(nombre_archivo, O_RDONLY);
+	if (descriptor < 0)
+		return NULL;
+	size_t tamanio = tamanio_archivo(descriptor);
+	carga_t carga = { 0 };
+	bool exito = (cantidad_hilos(tamanio, MINIMO_BYTES_POR_HILO) > 1) ?
+			     cargar_en_paralelo(descriptor, tamanio, &carga) :
+			     cargar_en_secuencia(descriptor, tamanio, &carga);
+	close(descriptor);
+	if (!exito || carga.cantidad == 0) {
+		carga_destruir(&carga);
+		return NULL;
+	}
+	for (size_t i = 0; i < carga.cantidad; i++)
+		carga.pokemones[i]->ingreso = i;
+	if (!ordenar_carga_por_prioridad(carga.pokemones, carga.cantidad)) {
+		carga_destruir(&carga);
+		return NULL;
+	}
+
+	hospital_t *hospital =
+		hospital_crear(carga.pokemones, carga.cantidad, carga.registros);
+	if (!hospital) {
+		carga_destruir(&carga);
+		return NULL;
+	}
+	free(carga.pokemones);
+	return hospital;
+}
+
+/**
+ * Devuelve la cantidad de pokemon del hospital, sin tomar el cerrojo.
+*/
+size_t cantidad_pokemones(hospital_t *hospital)
+{
+	if (!hospital)
+		return 0;
+	if (hospital->vista)
+		return vista_cantidad(hospital->vista);
+	return heap_tamanio(hospital->pokemones);
+}
+
+/**
+ * Devuelve la cantidad de pokemon que son atendidos actualmente en el hospital.
+ */
+size_t hospital_cantidad_pokemones(hospital_t *hospital)
+{
+	bloquear_lectura(hospital);
+	size_t cantidad = cantidad_pokemones(hospital);
+	desbloquear_lectura(hospital);
+	return cantidad;
+}
+
+/**
+ * Estructura auxiliar utilizada por hospital_a_cada_pokemon() para adaptar la
+ * funcion del usuario al iterador interno del arbol.
+*/
+typedef struct recorrido_pokemon {
+	bool (*funcion)(pokemon_t *p, void *aux);
+	void *aux;
+} recorrido_pokemon_t;
+
+/**
+ * Funcion utilizada por hospital_a_cada_pokemon() que invoca la funcion del
+ * usuario con cada pokemon recorrido del arbol (o de una lista del indice por
+ * entrenador).
+*/
+bool aplicar_funcion_a_pokemon(void *pokemon, void *recorrido)
+{
+	recorrido_pokemon_t *datos = recorrido;
+	return datos->funcion(pokemon, datos->aux);
+}
+
+/**
+ * Recorre el hospital como hospital_a_cada_pokemon(), sin tomar el cerrojo.
+*/
+size_t a_cada_pokemon(hospital_t *hospital,
+		      bool (*funcion)(pokemon_t *p, void *aux), void *aux)
+{
+	if (!hospital || !funcion)
+		return 0;
+	if (hospital->vista)
+		return vista_a_cada_pokemon(hospital->vista, 0,
+					    vista_cantidad(hospital->vista),
+					    funcion, aux);
+	recorrido_pokemon_t recorrido = { .funcion = funcion, .aux = aux };
+	return abb_con_cada_elemento(hospital->prioridades,
+				     aplicar_funcion_a_pokemon, &recorrido);
+}
+
+/**
+ * Recorre como a_cada_pokemon() solo los pokemon con prioridad en
+ * [desde, hasta), en O(log n) mas la cantidad de pokemon recorridos.
+*/
+size_t a_cada_pokemon_entre_prioridades(hospital_t *hospital, size_t desde,
+					size_t hasta,
+					bool (*funcion)(pokemon_t *p,
+							void *aux),
+					void *aux)
+{
+	if (!hospital || !funcion)
+		return 0;
+	if (hospital->vista)
+		return vista_a_cada_pokemon(hospital->vista, desde, hasta,
+					    funcion, aux);
+	recorrido_pokemon_t recorrido = { .funcion = funcion, .aux = aux };
+	return abb_con_cada_elemento_en_rango(hospital->prioridades, desde,
+					      hasta, aplicar_funcion_a_pokemon,
+					      &recorrido);
+}
+
+/**
+ * Aplica una función a cada uno de los pokemon almacenados en el hospital. La
+ * función debe aplicarse a cada pokemon en orden de prioridad (los de menor salud primero).
+ *
+ * La función a aplicar recibe el pokemon y la variable auxiliar que se le paso a hospital_a_cada_pokemon
+ * y devuelve true o false. Si la función devuelve true, se debe seguir aplicando la función a los próximos
+ * pokemon si quedan. Si la función devuelve false, no se debe continuar.
+ *
+ * Devuelve la cantidad de veces que se invocó la función (haya devuelto true o false).
+ */
+size_t hospital_a_cada_pokemon(hospital_t *hospital,
+			       bool (*funcion)(pokemon_t *p, void *aux),
+			       void *aux)
+{
+	bloquear_lectura(hospital);
+	size_t invocaciones = a_cada_pokemon(hospital, funcion, aux);
+	desbloquear_lectura(hospital);
+	return invocaciones;
+}
+
+/**
+ * Quita del hospital los ultimos pokemon ingresados del lote, en orden
+ * inverso, y les devuelve sus numeros de ingreso, para deshacer un lote que
+ * no pudo ingresar completo.
+*/
+void deshacer_ingresos(hospital_t *hospital, pokemon_t **pokemones,
+		       size_t ingresados)
+{
+	while (ingresados > 0) {
+		quitar_pokemon(hospital, pokemones[--ingresados]);
+		hospital->proximo_ingreso--;
+	}
+}
+
+/*
+ * Ingresa los pokemon al hospital sin tomar el cerrojo, y guarda en
+ * *ingresados cuantos ingresaron: todos o ninguno. El lote se registra en el
+ * diario despues de ingresar completo; si algun pokemon no puede ingresar o
+ * el registro falla, se deshacen los ingresos del lote, para que el hospital
+ * y el diario coincidan.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int aceptar_emergencias(hospital_t *hospital, pokemon_t **pokemones,
+			size_t cantidad, size_t *ingresados)
+{
+	size_t aceptados = 0;
+	bool exito = hospital && pokemones && !hospital->vista;
+	while (exito && aceptados < cantidad) {
+		exito = ingresar_pokemon(hospital, pokemones[aceptados]);
+		if (exito)
+			aceptados++;
+	}
+	if (exito && hospital->diario)
+		exito = diario_registrar_lote(hospital->diario,
+					      LOTE_EMERGENCIAS, pokemones,
+					      cantidad);
+	if (!exito && aceptados > 0) {
+		deshacer_ingresos(hospital, pokemones, aceptados);
+		aceptados = 0;
+	}
+	if (ingresados)
+		*ingresados = aceptados;
+	return (exito) ? EXITO : ERROR;
+}
+
+/**
+ *  Cuando ocurre una emergencia, llegan nuevos pokemones en ambulancia, que
+ *  deben ser ingresados al hospital.
+ *
+ *  No es necesario copiar los pokemon, tenes que quedarte con el puntero.
+ *  Recorda que a partir del momento que te guardas el puntero pasas a ser
+ *  responsable de la liberación de los pokemon.
+ *
+ *  Devuelve -1 en caso de error o 0 en caso de éxito
+ */
+int hospital_aceptar_emergencias(hospital_t *hospital,
+				 pokemon_t **pokemones_ambulancia,
+				 size_t cant_pokes_ambulancia)
+{
+	bloquear_escritura(hospital);
+	int resultado = aceptar_emergencias(hospital, pokemones_ambulancia,
+					    cant_pokes_ambulancia, NULL);
+	desbloquear_escritura(hospital);
+	return resultado;
+}
+
+/**
+ * Devuelve el pokemon con la prioridad indicada, sin tomar el cerrojo.
+*/
+pokemon_t *obtener_pokemon(hospital_t *hospital, size_t prioridad)
+{
+	if (prioridad >= cantidad_pokemones(hospital))
+		return NULL;
+	if (hospital->vista)
+		return vista_obtener_pokemon(hospital->vista, prioridad);
+	if (prioridad == 0)
+		return heap_raiz(hospital->pokemones);
+	return abb_elemento_en_posicion(hospital->prioridades, prioridad);
+}
+
+/**
+ * Devuelve el pokemon con la prioridad indicada (siendo 0 la mas alta prioridad, el pokemon con menos salúd).
+ *
+ * Si no existe la prioridad indicada devuelve NULL
+ */
+pokemon_t *hospital_obtener_pokemon(hospital_t *hospital, size_t prioridad)
+{
+	bloquear_lectura(hospital);
+	pokemon_t *pokemon = obtener_pokemon(hospital, prioridad);
+	desbloquear_lectura(hospital);
+	return pokemon;
+}
+
+/**
+ * Devuelve la cantidad de pokemon del hospital con salud menor a la indicada,
+ * que es la prioridad del primero con esa salud o mas, en O(log n).
+*/
+size_t cantidad_salud_menor(hospital_t *hospital, size_t salud)
+{
+	if (hospital->vista)
+		return vista_cantidad_salud_menor(hospital->vista, salud);
+	pokemon_t referencia = { .salud = salud, .ingreso = 0 };
+	return abb_cantidad_menores(hospital->prioridades, &referencia);
+}
+
+/**
+ * Calcula el tramo de prioridades [desde, hasta) de los pokemon con salud
+ * entre minimo y maximo, inclusive.
+*/
+void prioridades_en_rango(hospital_t *hospital, size_t minimo, size_t maximo,
+			  size_t *desde, size_t *hasta)
+{
+	*desde = cantidad_salud_menor(hospital, minimo);
+	*hasta = (maximo == SIZE_MAX) ?
+			 cantidad_pokemones(hospital) :
+			 cantidad_salud_menor(hospital, maximo + 1);
+}
+
+/**
+ * Cuenta los pokemon con salud en el rango, sin tomar el cerrojo.
+*/
+size_t contar_en_rango(hospital_t *hospital, size_t minimo, size_t maximo)
+{
+	if (!hospital || minimo > maximo)
+		return 0;
+	size_t desde, hasta;
+	prioridades_en_rango(hospital, minimo, maximo, &desde, &hasta);
+	return hasta - desde;
+}
+
+/*
+ * Devuelve la cantidad de pokemon con salud entre minimo y maximo, inclusive.
+ */
+size_t hospital_contar_en_rango(hospital_t *hospital, size_t minimo,
+				size_t maximo)
+{
+	bloquear_lectura(hospital);
+	size_t cantidad = contar_en_rango(hospital, minimo, maximo);
+	desbloquear_lectura(hospital);
+	return cantidad;
+}
+
+/**
+ * Recorre los pokemon con salud en el rango, sin tomar el cerrojo.
+*/
+size_t a_cada_pokemon_en_rango(hospital_t *hospital, size_t minimo,
+			       size_t maximo,
+			       bool (*funcion)(pokemon_t *p, void *aux),
+			       void *aux)
+{
+	if (!hospital || !funcion || minimo > maximo)
+		return 0;
+	size_t desde, hasta;
+	prioridades_en_rango(hospital, minimo, maximo, &desde, &hasta);
+	return a_cada_pokemon_entre_prioridades(hospital, desde, hasta,
+						funcion, aux);
+}
+
+/*
+ * Aplica la funcion a cada pokemon con salud entre minimo y maximo,
+ * inclusive, en orden de prioridad.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_en_rango(hospital_t *hospital, size_t minimo,
+					size_t maximo,
+					bool (*funcion)(pokemon_t *p,
+							void *aux),
+					void *aux)
+{
+	bloquear_lectura(hospital);
+	size_t invocaciones =
+		a_cada_pokemon_en_rango(hospital, minimo, maximo, funcion, aux);
+	desbloquear_lectura(hospital);
+	return invocaciones;
+}
+
+/*
+ * Guarda en *salud el percentil indicado de las saludes del hospital, segun
+ * el metodo del rango mas cercano.
+ *
+ * Devuelve -1 en caso de error o 0 en caso de éxito.
+ */
+int hospital_percentil_salud(hospital_t *hospital, double percentil,
+			     size_t *salud)
+{
+	if (!hospital || !salud || !(percentil >= 0 && percentil <= 100))
+		return ERROR;
+	bloquear_lectura(hospital);
+	size_t cantidad = cantidad_pokemones(hospital);
+	double exacto = percentil * (double)cantidad / 100;
+	size_t rango = (size_t)exacto;
+	if ((double)rango < exacto)
+		rango++;
+	if (cantidad > 0)
+		*salud = obtener_pokemon(hospital, (rango > 0) ? rango - 1 : 0)
+				 ->salud;
+	desbloquear_lectura(hospital);
+	return (cantidad > 0) ? EXITO : ERROR;
+}
+
+/*
+ * Devuelve la cantidad de pokemon del hospital con salud menor a la
+ * indicada.
+ */
+size_t hospital_contar_salud_menor_a(hospital_t *hospital, size_t salud)
+{
+	if (!hospital)
+		return 0;
+	bloquear_lectura(hospital);
+	size_t cantidad = cantidad_salud_menor(hospital, salud);
+	desbloquear_lectura(hospital);
+	return cantidad;
+}
+
+/*
+ * Guardan en *salud la salud minima o maxima del hospital.
+ *
+ * Devuelven -1 en caso de error o si el hospital esta vacio, o 0 en caso de
+ * éxito.
+ */
+int hospital_salud_minima(hospital_t *hospital, size_t *salud)
+{
+	return hospital_percentil_salud(hospital, 0, salud);
+}
+
+int hospital_salud_maxima(hospital_t *hospital, size_t *salud)
+{
+	return hospital_percentil_salud(hospital, 100, salud);
+}
+
+/**
+ * Funcion utilizada por hospital_salud_promedio() que suma la salud de cada
+ * pokemon recorrido de una vista.
+*/
+bool sumar_salud_de_vista(pokemon_t *pokemon, void *suma)
+{
+	*(size_t *)suma += pokemon->salud;
+	return true;
+}
+
+/*
+ * Guarda en *promedio la salud promedio del hospital.
+ *
+ * Devuelve -1 en caso de error o si el hospital esta vacio, o 0 en caso de
+ * éxito.
+ */
+int hospital_salud_promedio(hospital_t *hospital, double *promedio)
+{
+	if (!hospital || !promedio)
+		return ERROR;
+	bloquear_lectura(hospital);
+	size_t cantidad = cantidad_pokemones(hospital);
+	size_t suma = hospital->suma_salud;
+	if (hospital->vista) {
+		suma = 0;
+		vista_a_cada_pokemon(hospital->vista, 0, cantidad,
+				     sumar_salud_de_vista, &suma);
+	}
+	desbloquear_lectura(hospital);
+	if (cantidad == 0)
+		return ERROR;
+	*promedio = (double)suma / (double)cantidad;
+	return EXITO;
+}
+
+/**
+ * Tramo del recorrido paralelo que procesa un hilo: los pokemon con
+ * prioridad en [desde, hasta), con el aux propio del hilo. Todos los tramos
+ * comparten la bandera cortar, que se levanta cuando la funcion de alguno
+ * devuelve false.
+*/
+typedef struct tramo_recorrido {
+	abb_t *prioridades;
+	size_t desde;
+	size_t hasta;
+	bool (*funcion)(pokemon_t *p, void *aux);
+	void *aux;
+	bool *cortar;
+	size_t invocaciones;
+} tramo_recorrido_t;
+
+/**
+ * Funcion utilizada por recorrer_tramo() que invoca la funcion del usuario
+ * con cada pokemon del tramo, salvo que algun hilo haya pedido cortar.
+*/
+bool aplicar_funcion_en_tramo(void *pokemon, void *tramo)
+{
+	tramo_recorrido_t *datos = tramo;
+	if (__atomic_load_n(datos->cortar, __ATOMIC_RELAXED))
+		return false;
+	datos->invocaciones++;
+	if (datos->funcion(pokemon, datos->aux))
+		return true;
+	__atomic_store_n(datos->cortar, true, __ATOMIC_RELAXED);
+	return false;
+}
+
+/**
+ * Recorre en orden los pokemon del tramo. Tiene la firma de las funciones que
+ * ejecuta pthread_create().
+*/
+void *recorrer_tramo(void *tramo)
+{
+	tramo_recorrido_t *datos = tramo;
+	abb_con_cada_elemento_en_rango(datos->prioridades, datos->desde,
+				       datos->hasta, aplicar_funcion_en_tramo,
+				       datos);
+	return NULL;
+}
+
+/**
+ * Recorre el hospital en paralelo como hospital_a_cada_pokemon_paralelo(),
+ * sin tomar el cerrojo ni combinar los aux.
+*/
+size_t a_cada_pokemon_paralelo(hospital_t *hospital,
+			       bool (*funcion)(pokemon_t *p, void *aux),
+			       void **aux_por_hilo, size_t hilos)
+{
+	size_t cantidad = cantidad_pokemones(hospital);
+	size_t tramos = (hilos > MAXIMO_HILOS) ? MAXIMO_HILOS : hilos;
+	if (tramos > cantidad / MINIMO_POKEMON_POR_HILO)
+		tramos = cantidad / MINIMO_POKEMON_POR_HILO;
+	if (hospital->vista || tramos <= 1)
+		return a_cada_pokemon(hospital, funcion, aux_por_hilo[0]);
+	tramo_recorrido_t tareas[MAXIMO_HILOS];
+	bool cortar = false;
+	for (size_t i = 0; i < tramos; i++)
+		tareas[i] = (tramo_recorrido_t){
+			.prioridades = hospital->prioridades,
+			.desde = cantidad / tramos * i,
+			.hasta = (i + 1 == tramos) ? cantidad :
+						     cantidad / tramos * (i + 1),
+			.funcion = funcion,
+			.aux = aux_por_hilo[i],
+			.cortar = &cortar,
+		};
+	ejecutar_en_hilos(recorrer_tramo, tareas, sizeof(tramo_recorrido_t),
+			  tramos);
+	size_t invocaciones = 0;
+	for (size_t i = 0; i < tramos; i++)
+		invocaciones += tareas[i].invocaciones;
+	return invocaciones;
+}
+
+/*
+ * Aplica la funcion a cada pokemon del hospital repartiendo el orden de
+ * prioridad en tramos consecutivos, uno por hilo, cada uno con su aux. Al
+ * final combina los aux de todos los hilos en el primero.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_paralelo(
+	hospital_t *hospital, bool (*funcion)(pokemon_t *p, void *aux),
+	void **aux_por_hilo, size_t hilos,
+	void (*combinar)(void *aux, void *aux_hilo))
+{
+	if (!hospital || !funcion || !aux_por_hilo || hilos == 0)
+		return 0;
+	bloquear_lectura(hospital);
+	size_t invocaciones =
+		a_cada_pokemon_paralelo(hospital, funcion, aux_por_hilo, hilos);
+	desbloquear_lectura(hospital);
+	for (size_t i = 1; combinar && i < hilos; i++)
+		combinar(aux_por_hilo[0], aux_por_hilo[i]);
+	return invocaciones;
+}
+
+/**
+ * Vector donde hospital_peores_k() guarda los primeros k pokemon recorridos.
+*/
+typedef struct peores_pokemon {
+	pokemon_t **vector;
+	size_t cantidad;
+	size_t k;
+} peores_pokemon_t;
+
+/**
+ * Funcion utilizada por hospital_peores_k() que guarda el pokemon recorrido
+ * en el vector y corta el recorrido al llegar a k.
+*/
+bool guardar_peor_pokemon(pokemon_t *pokemon, void *peores)
+{
+	peores_pokemon_t *datos = peores;
+	datos->vector[datos->cantidad++] = pokemon;
+	return datos->cantidad < datos->k;
+}
+
+/**
+ * Guarda los k pokemon de mayor prioridad, sin tomar el cerrojo. Como el
+ * arbol ya esta en orden de prioridad, alcanza con recorrerlo inorden y
+ * cortar en el k-esimo: se visitan O(log n + k) nodos.
+*/
+size_t peores_k(hospital_t *hospital, size_t k, pokemon_t **peores)
+{
+	if (!hospital || !peores || k == 0)
+		return 0;
+	peores_pokemon_t guardados = { .vector = peores, .k = k };
+	if (hospital->vista) {
+		// Los recorridos de la vista no materializan los pokemon, y
+		// estos se devuelven: se materializan solo los k pedidos.
+		size_t cantidad = vista_cantidad(hospital->vista);
+		while (guardados.cantidad < k && guardados.cantidad < cantidad) {
+			pokemon_t *pokemon = vista_obtener_pokemon(
+				hospital->vista, guardados.cantidad);
+			if (!pokemon)
+				break;
+			peores[guardados.cantidad++] = pokemon;
+		}
+		return guardados.cantidad;
+	}
+	recorrido_pokemon_t recorrido = { .funcion = guardar_peor_pokemon,
+					  .aux = &guardados };
+	abb_con_cada_elemento(hospital->prioridades, aplicar_funcion_a_pokemon,
+			      &recorrido);
+	return guardados.cantidad;
+}
+
+/*
+ * Guarda en el vector los k pokemon de mayor prioridad, en orden.
+ *
+ * Devuelve la cantidad de pokemon guardados, o 0 en caso de error.
+ */
+size_t hospital_peores_k(hospital_t *hospital, size_t k, pokemon_t **peores)
+{
+	bloquear_lectura(hospital);
+	size_t cantidad = peores_k(hospital, k, peores);
+	desbloquear_lectura(hospital);
+	return cantidad;
+}
+
+/**
+ * Estructura auxiliar utilizada por construir_indice() para agregar cada
+ * pokemon recorrido del arbol al indice.
+*/
+typedef struct construccion_indice {
+	hash_t *indice;
+	bool (*indexar)(hash_t *indice, pokemon_t *pokemon);
+} construccion_indice_t;
+
+/**
+ * Funcion utilizada por construir_indice() que agrega cada pokemon recorrido
+ * al indice.
+*/
+bool agregar_a_indice(void *pokemon, void *construccion)
+{
+	construccion_indice_t *datos = construccion;
+	return datos->indexar(datos->indice, pokemon);
+}
+
+/**
+ * Construye un indice con todos los pokemon del hospital, agregandolos con
+ * la funcion recibida.
+ *
+ * Devuelve el indice construido o NULL en caso de error.
+*/
+hash_t *construir_indice(hospital_t *hospital,
+			 bool (*indexar)(hash_t *indice, pokemon_t *pokemon))
+{
+	size_t cantidad = cantidad_pokemones(hospital);
+	construccion_indice_t construccion = {
+		.indice = hash_crear(cantidad * 2),
+		.indexar = indexar,
+	};
+	if (!construccion.indice)
+		return NULL;
+	if (abb_con_cada_elemento(hospital->prioridades, agregar_a_indice,
+				  &construccion) != cantidad) {
+		destruir_indice(construccion.indice);
+		return NULL;
+	}
+	return construccion.indice;
+}
+
+/**
+ * Devuelve el indice guardado en *indice, construyendolo si todavia no
+ * existe.
+ *
+ * Varios lectores de un hospital concurrente pueden pedir el mismo indice a
+ * la vez: solo uno lo construye (bajo el mutex de construccion) y lo publica
+ * con una escritura atomica, y el resto lo lee ya construido.
+ *
+ * Devuelve NULL en caso de error.
+*/
+hash_t *obtener_indice(hospital_t *hospital, hash_t **indice,
+		       bool (*indexar)(hash_t *indice, pokemon_t *pokemon))
+{
+	hash_t *existente = __atomic_load_n(indice, __ATOMIC_ACQUIRE);
+	if (existente)
+		return existente;
+	bloquear_construccion(hospital);
+	existente = __atomic_load_n(indice, __ATOMIC_ACQUIRE);
+	if (!existente) {
+		existente = construir_indice(hospital, indexar);
+		__atomic_store_n(indice, existente, __ATOMIC_RELEASE);
+	}
+	desbloquear_construccion(hospital);
+	return existente;
+}
+
+/**
+ * Devuelve el pokemon con el id indicado que ingreso primero al hospital,
+ * construyendo el indice por id si todavia no existe, o NULL si no hay
+ * ninguno o en caso de error.
+*/
+pokemon_t *primero_con_id(hospital_t *hospital, size_t id)
+{
+	char clave[MAXIMO_CARACTERES_ID];
+	clave_id(id, clave);
+	return primero_con_clave(
+		obtener_indice(hospital, &hospital->indice_id, indexar_id),
+		clave);
+}
+
+/**
+ * Criterios de busqueda sobre la vista de un hospital mapeado en memoria, que
+ * no tiene indices: devuelven true si el pokemon tiene el id, el nombre o el
+ * entrenador buscado.
+*/
+bool coincide_id(const pokemon_t *pokemon, const void *id)
+{
+	return pokemon->id == *(const size_t *)id;
+}
+
+bool coincide_nombre(const pokemon_t *pokemon, const void *nombre)
+{
+	return strcmp(pokemon->nombre, nombre) == 0;
+}
+
+bool coincide_entrenador(const pokemon_t *pokemon, const void *entrenador)
+{
+	return strcmp(pokemon->nombre_entrenador, entrenador) == 0;
+}
+
+/**
+ * Busca la prioridad del pokemon con el id indicado, sin tomar el cerrojo.
+*/
+int prioridad_pokemon(hospital_t *hospital, size_t id, size_t *prioridad)
+{
+	if (!hospital || !prioridad)
+		return ERROR;
+	if (hospital->vista)
+		return (vista_buscar_primero(hospital->vista, coincide_id, &id,
+					     prioridad)) ?
+			       EXITO :
+			       ERROR;
+	pokemon_t *pokemon = primero_con_id(hospital, id);
+	if (!pokemon ||
+	    !abb_posicion(hospital->prioridades, pokemon, prioridad))
+		return ERROR;
+	return EXITO;
+}
+
+/**
+ * Busca el pokemon con el id indicado y guarda en *prioridad su prioridad
+ * actual.
+ *
+ * Devuelve -1 en caso de error o si no existe el pokemon, o 0 en caso de éxito.
+ */
+int hospital_prioridad_pokemon(hospital_t *hospital, size_t id,
+			       size_t *prioridad)
+{
+	bloquear_lectura(hospital);
+	int resultado = prioridad_pokemon(hospital, id, prioridad);
+	desbloquear_lectura(hospital);
+	return resultado;
+}
+
+/**
+ * Busca el pokemon con el id indicado, sin tomar el cerrojo.
+*/
+pokemon_t *buscar_por_id(hospital_t *hospital, size_t id)
+{
+	if (!hospital)
+		return NULL;
+	size_t prioridad;
+	if (hospital->vista)
+		return (vista_buscar_primero(hospital->vista, coincide_id, &id,
+					     &prioridad)) ?
+			       vista_obtener_pokemon(hospital->vista,
+						     prioridad) :
+			       NULL;
+	return primero_con_id(hospital, id);
+}
+
+/*
+ * Devuelve el pokemon con el id indicado (el que ingreso primero, si hay
+ * varios) o NULL si no existe o en caso de error.
+ */
+pokemon_t *hospital_buscar_por_id(hospital_t *hospital, size_t id)
+{
+	bloquear_lectura(hospital);
+	pokemon_t *pokemon = buscar_por_id(hospital, id);
+	desbloquear_lectura(hospital);
+	return pokemon;
+}
+
+/**
+ * Busca el pokemon con el nombre indicado, sin tomar el cerrojo.
+*/
+pokemon_t *buscar_por_nombre(hospital_t *hospital, const char *nombre)
+{
+	if (!hospital || !nombre)
+		return NULL;
+	size_t prioridad;
+	if (hospital->vista)
+		return (vista_buscar_primero(hospital->vista, coincide_nombre,
+					     nombre, &prioridad)) ?
+			       vista_obtener_pokemon(hospital->vista,
+						     prioridad) :
+			       NULL;
+	return primero_con_clave(obtener_indice(hospital,
+						&hospital->indice_nombre,
+						indexar_nombre),
+				 nombre);
+}
+
+/*
+ * Devuelve el pokemon con el nombre indicado (el que ingreso primero, si hay
+ * varios) o NULL si no existe o en caso de error.
+ */
+pokemon_t *hospital_buscar_por_nombre(hospital_t *hospital,
+				      const char *nombre)
+{
+	bloquear_lectura(hospital);
+	pokemon_t *pokemon = buscar_por_nombre(hospital, nombre);
+	desbloquear_lectura(hospital);
+	return pokemon;
+}
+
+/**
+ * Recorre los pokemon del entrenador indicado, sin tomar el cerrojo.
+*/
+size_t a_cada_pokemon_de_entrenador(hospital_t *hospital,
+				    const char *entrenador,
+				    bool (*funcion)(pokemon_t *p, void *aux),
+				    void *aux)
+{
+	if (!hospital || !entrenador || !funcion)
+		return 0;
+	if (hospital->vista)
+		return vista_a_cada_coincidencia(hospital->vista,
+						 coincide_entrenador,
+						 entrenador, funcion, aux);
+	lista_t *pokemones = hash_obtener(
+		obtener_indice(hospital, &hospital->indice_entrenador,
+			       indexar_entrenador),
+		entrenador);
+	if (!pokemones)
+		return 0;
+	recorrido_pokemon_t recorrido = { .funcion = funcion, .aux = aux };
+	return lista_con_cada_elemento(pokemones,
+				       aplicar_funcion_a_pokemon,
+				       &recorrido);
+}
+
+/*
+ * Aplica la funcion a cada pokemon del entrenador indicado.
+ *
+ * Devuelve la cantidad de veces que se invoco la funcion.
+ */
+size_t hospital_a_cada_pokemon_de_entrenador(
+	hospital_t *hospital, const char *entrenador,
+	bool (*funcion)(pokemon_t *p, void *aux), void *aux)
+{
+	bloquear_lectura(hospital);
+	size_t invocaciones = a_cada_pokemon_de_entrenador(hospital, entrenador,
+							   funcion, aux);
+	desbloquear_lectura(hospital);
+	return invocaciones;
+}
+
+/**
+ * Atiende al pokemon de mayor prioridad, sin tomar el cerrojo.
+*/
+pokemon_t *atender_siguiente(hospital_t *hospital)
+{
+	if (!hospital || hospital->vista)
+		return NULL;
+	pokemon_t *siguiente = heap_raiz(hospital->pokemones);
+	if (!siguiente)
+		return NULL;
+	bool en_arena = arena_contiene(hospital->registros, siguiente);
+	pokemon_t *atendido = (en_arena) ? pokemon_copiar(siguiente) : siguiente;
+	if (!atendido)
+		return NULL;
+	if (hospital->diario &&
+	    !diario_registrar_lote(hospital->diario, LOTE_ATENCION, &siguiente,
+				   1)) {
+		if (en_arena)
+			pokemon_destruir(atendido);
+		return NULL;
+	}
+	quitar_primer_pokemon(hospital);
+	if (en_arena)
+		arena_liberar(hospital->registros, siguiente);
+	return atendido;
+}
+
+/*
+ * Atiende al pokemon de mayor prioridad y lo quita del hospital. Si el
+ * pokemon vive en la arena del hospital, se devuelve una copia y su registro
+ * vuelve a la arena.
+ *
+ * Devuelve NULL si el hospital esta vacio o en caso de error.
+ */
+pokemon_t *hospital_atender_siguiente(hospital_t *hospital)
+{
+	bloquear_escritura(hospital);
+	pokemon_t *atendido = atender_siguiente(hospital);
+	desbloquear_escritura(hospital);
+	return atendido;
+}
+
+/**
+ * Cambia la salud del pokemon con el id indicado, sin tomar el cerrojo.
+*/
+int actualizar_salud(hospital_t *hospital, size_t id, size_t nueva_salud)
+{
+	if (!hospital || hospital->vista)
+		return ERROR;
+	pokemon_t *pokemon = primero_con_id(hospital, id);
+	if (!pokemon)
+		return ERROR;
+	if (hospital->diario) {
+		pokemon_t actualizado = *pokemon;
+		actualizado.salud = nueva_salud;
+		pokemon_t *lote = &actualizado;
+		if (!diario_registrar_lote(hospital->diario, LOTE_ACTUALIZACION,
+					   &lote, 1))
+			return ERROR;
+	}
+	cambiar_salud_pokemon(hospital, pokemon, nueva_salud);
+	return EXITO;
+}
+
+/*
+ * Cambia la salud del pokemon con el id indicado y actualiza su prioridad.
+ *
+ * Devuelve -1 en caso de error o si no existe el pokemon, o 0 en caso de éxito.
+ */
+int hospital_actualizar_salud(hospital_t *hospital, size_t id,
+			      size_t nueva_salud)
+{
+	bloquear_escritura(hospital);
+	int resultado = actualizar_salud(hospital, id, nueva_salud);
+	desbloquear_escritura(hospital);
+	return resultado;
+}
+
+/**
+ * Estado de la mezcla de hospital_fusionar(): el vector donde se escribe el
+ * orden fusionado y los pokemon del origen, en orden de prioridad, que
+ * ocupan el final del mismo vector.
+*/
+typedef struct mezcla_pokemones {
+	pokemon_t **fusionados;
+	size_t escritos;
+	pokemon_t **origen;
+	size_t leidos_origen;
+	size_t cantidad_origen;
+} mezcla_pokemones_t;
+
+/**
+ * Funcion utilizada por mezclar_prioridades() que recibe cada pokemon del
+ * destino en orden y escribe antes los del origen con menos salud. A igual
+ * salud va primero el del destino, que tiene el menor numero de ingreso.
+ *
+ * Como cada pokemon del origen se lee antes de escribir en su posicion, la
+ * mezcla puede hacerse en el mismo vector.
+*/
+bool mezclar_con_origen(void *pokemon, void *mezcla)
+{
+	mezcla_pokemones_t *datos = mezcla;
+	pokemon_t *actual = pokemon;
+	while (datos->leidos_origen < datos->cantidad_origen &&
+	       datos->origen[datos->leidos_origen]->salud < actual->salud)
+		datos->fusionados[datos->escritos++] =
+			datos->origen[datos->leidos_origen++];
+	datos->fusionados[datos->escritos++] = actual;
+	return true;
+}
+
+/**
+ * Mezcla en el vector el orden de prioridad del destino (recorriendo su
+ * arbol) con el del origen, que ya esta en las ultimas cantidad_origen
+ * posiciones del vector. Cuesta O(n + m).
+*/
+void mezclar_prioridades(hospital_t *destino, pokemon_t **fusionados,
+			 size_t cantidad_origen)
+{
+	mezcla_pokemones_t mezcla = {
+		.fusionados = fusionados,
+		.origen = fusionados + cantidad_pokemones(destino),
+		.cantidad_origen = cantidad_origen,
+	};
+	abb_con_cada_elemento(destino->prioridades, mezclar_con_origen,
+			      &mezcla);
+	while (mezcla.leidos_origen < cantidad_origen)
+		fusionados[mezcla.escritos++] =
+			mezcla.origen[mezcla.leidos_origen++];
+}
+
+/**
+ * Funcion utilizada por hospital_fusionar() que asigna a cada pokemon del
+ * origen, en orden de prioridad, el siguiente numero de ingreso del destino.
+*/
+bool renumerar_ingreso(void *pokemon, void *proximo_ingreso)
+{
+	((pokemon_t *)pokemon)->ingreso = (*(size_t *)proximo_ingreso)++;
+	return true;
+}
+
+/**
+ * Libera lo que queda del origen despues de fusionarlo: sus pokemon, su
+ * arena y sus estadisticas ya son del destino.
+*/
+void destruir_origen_fusionado(hospital_t *origen)
+{
+	descartar_version(origen);
+	diario_cerrar(origen->diario);
+	destruir_indice(origen->indice_id);
+	destruir_indice(origen->indice_nombre);
+	destruir_indice(origen->indice_entrenador);
+	abb_destruir(origen->prioridades);
+	heap_destruir(origen->pokemones);
+	cerrojo_destruir(origen->cerrojo);
+	free(origen);
+}
+
+/**
+ * Registra en el diario del destino (si tiene uno) el ingreso de los pokemon
+ * del origen como un lote de emergencias, en orden de prioridad del origen:
+ * al recuperar el hospital, el lote les asigna los mismos numeros de ingreso
+ * que hospital_fusionar().
+ *
+ * Devuelve false en caso de error.
+*/
+bool registrar_fusion(hospital_t *destino, hospital_t *origen)
+{
+	size_t cantidad = cantidad_pokemones(origen);
+	if (!destino->diario || cantidad == 0)
+		return true;
+	pokemon_t **lote = malloc(cantidad * sizeof(pokemon_t *));
+	if (!lote)
+		return false;
+	peores_k(origen, cantidad, lote);
+	bool exito = diario_registrar_lote(destino->diario, LOTE_EMERGENCIAS,
+					   lote, cantidad);
+	free(lote);
+	return exito;
+}
+
+/**
+ * Prepara la fusion del origen en el destino sin modificar ninguno de los
+ * dos: mezcla ambos ordenes de prioridad en el vector fusionados (con lugar
+ * para los pokemon de ambos), construye el arbol del orden fusionado y mueve
+ * las estadisticas de los entrenadores nuevos. Lo ultimo que hace es
+ * registrar la fusion en el diario, que no se puede deshacer.
+ *
+ * Devuelve el arbol construido o NULL en caso de error.
+*/
+abb_t *preparar_fusion(hospital_t *destino, hospital_t *origen,
+		       pokemon_t **fusionados)
+{
+	size_t cantidad_destino = cantidad_pokemones(destino);
+	size_t cantidad_origen = cantidad_pokemones(origen);
+	peores_k(origen, cantidad_origen, fusionados + cantidad_destino);
+	mezclar_prioridades(destino, fusionados, cantidad_origen);
+	abb_t *prioridades = abb_crear_desde_ordenados(
+		comparar_prioridad_pokemones, (void **)fusionados,
+		cantidad_destino + cantidad_origen);
+	if (!prioridades)
+		return NULL;
+	if (!preparar_fusion_estadisticas(destino, origen)) {
+		abb_destruir(prioridades);
+		return NULL;
+	}
+	if (!registrar_fusion(destino, origen)) {
+		deshacer_fusion_estadisticas(destino, origen);
+		abb_destruir(prioridades);
+		return NULL;
+	}
+	return prioridades;
+}
+
+/**
+ * Toman y sueltan en exclusiva los cerrojos de ambos hospitales, siempre en
+ * el orden de sus direcciones, para que dos fusiones con los mismos
+ * hospitales en distinto orden no se esperen mutuamente.
+*/
+void bloquear_fusion(hospital_t *destino, hospital_t *origen)
+{
+	bool destino_primero = (uintptr_t)destino < (uintptr_t)origen;
+	bloquear_escritura((destino_primero) ? destino : origen);
+	bloquear_escritura((destino_primero) ? origen : destino);
+}
+
+void desbloquear_fusion(hospital_t *destino, hospital_t *origen)
+{
+	desbloquear_escritura(origen);
+	desbloquear_escritura(destino);
+}
+
+/*
+ * Pasa todos los pokemon del origen al destino y destruye el origen,
+ * mezclando ambos ordenes de prioridad en O(n + m).
+ *
+ * Devuelve -1 en caso de error (y ambos hospitales quedan como estaban) o 0
+ * en caso de éxito.
+ */
+int hospital_fusionar(hospital_t *destino, hospital_t *origen)
+{
+	if (!destino || !origen || destino == origen || destino->vista ||
+	    origen->vista)
+		return ERROR;
+	bloquear_fusion(destino, origen);
+	size_t cantidad_destino = cantidad_pokemones(destino);
+	size_t cantidad_origen = cantidad_pokemones(origen);
+	size_t total = cantidad_destino + cantidad_origen;
+	size_t capacidad = (total > 0) ? total : 1;
+	pokemon_t **fusionados = NULL;
+	if (total >= cantidad_destino &&
+	    capacidad <= SIZE_MAX / sizeof(pokemon_t *))
+		fusionados = malloc(capacidad * sizeof(pokemon_t *));
+	abb_t *prioridades =
+		(fusionados) ? preparar_fusion(destino, origen, fusionados) :
+			       NULL;
+	if (!prioridades) {
+		free(fusionados);
+		desbloquear_fusion(destino, origen);
+		return ERROR;
+	}
+
+	// Desde aca nada puede fallar: el vector cumple por construccion las
+	// condiciones de heap_reemplazar_vector(), y las arenas de ambos
+	// hospitales tienen registros de pokemon_t, como pide
+	// arena_absorber(); que alguna falle seria un error del programa.
+	// Los pokemon del origen toman los siguientes numeros de ingreso del
+	// destino en su orden de prioridad, por lo que el orden fusionado no
+	// cambia.
+	assert(capacidad > 0 && total <= capacidad);
+	abb_con_cada_elemento(origen->prioridades, renumerar_ingreso,
+			      &destino->proximo_ingreso);
+	bool reemplazado = heap_reemplazar_vector(
+		destino->pokemones, (void **)fusionados, total, capacidad);
+	assert(reemplazado);
+	(void)reemplazado;
+	abb_destruir(destino->prioridades);
+	destino->prioridades = prioridades;
+	completar_fusion_estadisticas(destino, origen);
+	destino->suma_salud += origen->suma_salud;
+	if (!destino->registros) {
+		destino->registros = origen->registros;
+	} else if (origen->registros) {
+		bool absorbida =
+			arena_absorber(destino->registros, origen->registros);
+		assert(absorbida);
+		(void)absorbida;
+	}
+
+	// Los indices del destino se vuelven a construir en la proxima
+	// consulta, con los pokemon de ambos hospitales.
+	destruir_indice(destino->indice_id);
+	destruir_indice(destino->indice_nombre);
+	destruir_indice(destino->indice_entrenador);
+	destino->indice_id = NULL;
+	destino->indice_nombre = NULL;
+	destino->indice_entrenador = NULL;
+	descartar_version(destino);
+
+	desbloquear_fusion(destino, origen);
+	destruir_origen_fusionado(origen);
+	return EXITO;
+}
+
+/**
+ * Funcion utilizada por hospital_destruir() que libera el pokemon recorrido
+ * solo si no pertenece a la arena del hospital (es decir, si llego en
+ * ambulancia).
+*/
+bool destruir_pokemon_externo(void *pokemon, void *registros)
+{
+	if (!arena_contiene(registros, pokemon))
+		pokemon_destruir(pokemon);
+	return true;
+}
+
+/**
+ *  Libera el hospital y toda la memoria utilizada por el mismo.
+ */
+void hospital_destruir(hospital_t *hospital)
+{
+	if (!hospital)
+		return;
+	descartar_version(hospital);
+	if (hospital->vista) {
+		vista_destruir(hospital->vista);
+		free(hospital);
+		return;
+	}
+	if (arena_cantidad(hospital->registros) < cantidad_pokemones(hospital))
+		abb_con_cada_elemento(hospital->prioridades,
+				      destruir_pokemon_externo,
+				      hospital->registros);
+	diario_cerrar(hospital->diario);
+	destruir_indice(hospital->indice_id);
+	destruir_indice(hospital->indice_nombre);
+	destruir_indice(hospital->indice_entrenador);
+	destruir_estadisticas(hospital->estadisticas);
+	abb_destruir(hospital->prioridades);
+	heap_destruir(hospital->pokemones);
+	arena_destruir(hospital->registros);
+	cerrojo_destruir(hospital->cerrojo);
 	free(hospital);
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
 
 #include "src/tp1.h"
+#include "src/hospital.h"
 #include "src/menu.h"
+#include "src/lector.h"
 
 #define MAXIMO_CARACTERES 256
+#define MAXIMO_CARACTERES_MENSAJE 4096
 #define CAPACIDAD_DEFAULT_HASH_HOSPITALES 10
 
 typedef struct wrapper_hospital {
@@ -18,22 +24,46 @@ typedef struct hash_hospital {
 	wrapper_hospital_t *hospital_activo;
 	size_t id_generador;
 	size_t cantidad;
+	lector_t *entrada;
 } hash_hospital_t;
 
-void registrar_entrada_usuario(char str[])
+/**
+ * Lee una linea de la entrada y copia en str su primera palabra (de a lo sumo
+ * MAXIMO_CARACTERES - 1 caracteres). Una linea vacia o demasiado larga deja
+ * str vacio.
+ *
+ * Devuelve false si se llego al final de la entrada o si fallo la lectura.
+ */
+bool leer_palabra(lector_t *entrada, char str[])
+{
+	str[0] = '\0';
+	fflush(stdout);
+	char *linea = lector_leer_linea(entrada, NULL);
+	if (!linea)
+		return lector_linea_demasiado_larga(entrada);
+	linea += strspn(linea, " \t\r");
+	size_t largo = strcspn(linea, " \t\r");
+	if (largo >= MAXIMO_CARACTERES)
+		largo = MAXIMO_CARACTERES - 1;
+	memcpy(str, linea, largo);
+	str[largo] = '\0';
+	return true;
+}
+
+bool registrar_entrada_usuario(lector_t *entrada, char str[])
 {
 	printf("« COMANDO » ");
-	scanf("%255s", str);
+	return leer_palabra(entrada, str);
 }
 
 void mostrar_mensaje_determinado(char *src)
 {
-	FILE *archivo = fopen(src, "r");
-	char linea[MAXIMO_CARACTERES];
-	while (fscanf(archivo, "%[^\n]\n", linea) == 1)
+	lector_t *archivo = lector_abrir(src, MAXIMO_CARACTERES_MENSAJE);
+	char *linea = NULL;
+	while ((linea = lector_leer_linea(archivo, NULL)))
 		printf("%s\n", linea);
 	printf("\n");
-	fclose(archivo);
+	lector_destruir(archivo);
 }
 
 bool mi_menu_salir(void *dato, void *contexto)
@@ -75,9 +105,9 @@ bool mi_menu_cargar(void *dato, void *contexto)
 	hash_hospital_t *principal = (hash_hospital_t *)dato;
 	char src[MAXIMO_CARACTERES];
 	printf("\n[ Ingrese la direccion del archivo. Para cancelar, escriba « N » ]: ");
-	scanf("%255s", src);
 	char cancelar[] = "N";
-	if (strcmp(src, cancelar) == 0) {
+	if (!leer_palabra(principal->entrada, src) ||
+	    strcmp(src, cancelar) == 0) {
 		printf("\n");
 		return true;
 	}
@@ -92,7 +122,11 @@ bool mi_menu_cargar(void *dato, void *contexto)
 	wrapper_hospital_t *hospital = calloc(1, sizeof(wrapper_hospital_t));
 	if (!hospital)
 		return false;
-	hospital->hospital = hospital_crear_desde_archivo(src);
+	// Un archivo binario se reconoce por su encabezado; si no lo es, se
+	// interpreta como CSV.
+	hospital->hospital = hospital_cargar_binario(src);
+	if (!hospital->hospital)
+		hospital->hospital = hospital_crear_desde_archivo(src);
 	if (!hospital->hospital)
 		return liberar_memoria_hospital(hospital);
 
@@ -154,9 +188,9 @@ bool mi_menu_activar(void *dato, void *contexto)
 
 	char src[MAXIMO_CARACTERES];
 	printf("\n[ Ingrese un numero de identificacion de un hospital. Para cancelar, escriba « N » ]: ");
-	scanf("%255s", src);
 	char cancelar[] = "N";
-	if (strcmp(src, cancelar) == 0) {
+	if (!leer_palabra(principal->entrada, src) ||
+	    strcmp(src, cancelar) == 0) {
 		printf("\n");
 		return true;
 	}
@@ -281,7 +315,7 @@ menu_t *inicializar_menu(char *nombre_menu)
 
 	char *tecla_cargar = reservar_memoria_string("C");
 	char *descripcion_cargar = reservar_memoria_string(
-		"Cargar: Pide un nombre de archivo e intenta cargarlo creando un hospital. El hospital queda identificado con un número y el nombre del archivo.");
+		"Cargar: Pide un nombre de archivo (CSV o binario) e intenta cargarlo creando un hospital. El hospital queda identificado con un número y el nombre del archivo.");
 	bool no_problema3 = menu_agregar_opcion(
 		menu, tecla_cargar, descripcion_cargar, mi_menu_cargar, NULL);
 	if (!no_problema3) {
@@ -363,6 +397,7 @@ void terminar_ejecucion(menu_t *menu, hash_hospital_t *hash_hospital)
 	if (hash_hospital != NULL) {
 		hash_destruir_todo(hash_hospital->hash,
 				   funcion_destructora_hospitales);
+		lector_destruir(hash_hospital->entrada);
 		free(hash_hospital);
 	}
 }
@@ -374,7 +409,12 @@ int main(int argc, char *argv[])
 	char nombre_menu[] = "Menu - Hospital Pokemon";
 	menu_t *menu = inicializar_menu(nombre_menu);
 	hash_hospital_t *hash_hospitales = calloc(1, sizeof(hash_hospital_t));
-	hash_hospitales->hash = hash_crear(CAPACIDAD_DEFAULT_HASH_HOSPITALES);
+	if (hash_hospitales) {
+		hash_hospitales->hash =
+			hash_crear(CAPACIDAD_DEFAULT_HASH_HOSPITALES);
+		hash_hospitales->entrada =
+			lector_crear(STDIN_FILENO, MAXIMO_CARACTERES_MENSAJE);
+	}
 
 	char src_mensaje_menu_principal[] = "mensajes/mensaje_principal.txt";
 	char src_mensaje_error[] = "mensajes/mensaje_error.txt";
@@ -383,7 +423,8 @@ int main(int argc, char *argv[])
 		"mensajes/mensaje_comando_incorrecto.txt";
 	char src_mensaje_finalizacion[] = "mensajes/mensaje_finalizacion.txt";
 
-	if (!menu || !hash_hospitales || !hash_hospitales->hash) {
+	if (!menu || !hash_hospitales || !hash_hospitales->hash ||
+	    !hash_hospitales->entrada) {
 		mostrar_mensaje_determinado(src_mensaje_error);
 		terminar_ejecucion(menu, hash_hospitales);
 		return 201;
@@ -397,7 +438,11 @@ int main(int argc, char *argv[])
 	bool funcionamiento = true;
 	while (funcionamiento) {
 		char entrada[MAXIMO_CARACTERES];
-		registrar_entrada_usuario(entrada);
+		if (!registrar_entrada_usuario(hash_hospitales->entrada,
+					       entrada)) {
+			printf("\n");
+			strcpy(entrada, tecla_salir);
+		}
 		if (!menu_obtener_descripcion(menu, entrada))
 			mostrar_mensaje_determinado(
 				src_mensaje_comando_incorrecto);